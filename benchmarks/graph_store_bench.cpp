@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+#include "graph_store.hpp"
+#include "util/graph_generator.hpp"
+#include "util/graph_util.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // The shapes of the benchmarked graphs.
+    enum class GraphShape {
+        // Erdős–Rényi graph, kAverageDegree uniformly random edges per vertex.
+        ERDOS_RENYI,
+        // R-MAT graph with the power law degrees, kAverageDegree edges per vertex on average.
+        RMAT,
+        // Square grid, or twice as wide as high for the odd powers of two.
+        GRID,
+        // Path through all vertices in both directions, the searches are as deep as the graph.
+        CHAIN
+    };
+
+    constexpr std::uint64_t kAverageDegree = 8;
+
+    constexpr std::uint64_t kSeed = 42;
+
+    // The number of precomputed random vertex pairs the benchmarks cycle through.
+    constexpr std::size_t kPairCount = 1 << 12;
+
+    const std::vector<graph_store::GraphStore::Strategy> kStrategies = {
+            graph_store::GraphStore::Strategy::OPTIMIZED_PERFORMANCE,
+            graph_store::GraphStore::Strategy::OPTIMIZED_MEMORY,
+            graph_store::GraphStore::Strategy::OPTIMIZED_RESET};
+
+    // The layouts compared by BM_ShortestPath: the vector per vertex, the contiguous CSR and the gap-encoded CSR.
+    const std::vector<graph_store::GraphStore::AdjacencyLayout> kLayouts = {
+            graph_store::GraphStore::AdjacencyLayout::ADJACENCY_LIST,
+            graph_store::GraphStore::AdjacencyLayout::CSR,
+            graph_store::GraphStore::AdjacencyLayout::COMPRESSED_CSR};
+
+    const char *const kStrategyNames[] = {"OPTIMIZED_PERFORMANCE", "OPTIMIZED_MEMORY", "OPTIMIZED_RESET"};
+    const char *const kShapeNames[] = {"ERDOS_RENYI", "RMAT", "GRID", "CHAIN"};
+    const char *const kLayoutNames[] = {"ADJACENCY_LIST", "CSR", "COMPRESSED_CSR"};
+
+    const graph_util::Label kLabel = "benchLabel";
+
+    // Generates the graph of the shape, vertex_count should be a power of two.
+    std::vector<graph_util::Edge> GenerateEdges(const GraphShape shape, const std::uint64_t vertex_count) {
+        std::uint64_t scale = 0;
+        while ((std::uint64_t(1) << scale) < vertex_count) {
+            ++scale;
+        }
+        switch (shape) {
+            case GraphShape::ERDOS_RENYI:
+                return graph_util::GenerateErdosRenyiGraph(vertex_count, vertex_count * kAverageDegree, kSeed);
+            case GraphShape::RMAT:
+                return graph_util::GenerateRmatGraph(scale, vertex_count * kAverageDegree, {}, kSeed);
+            case GraphShape::GRID:
+                return graph_util::GenerateGridGraph(std::uint64_t(1) << (scale / 2),
+                                                     std::uint64_t(1) << (scale - scale / 2));
+            case GraphShape::CHAIN:
+                return graph_util::GenerateChainGraph(vertex_count, true);
+        }
+        return {};
+    }
+
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> GeneratePairs(const std::uint64_t vertex_count) {
+        // Not kSeed, the pairs would repeat the edges of the Erdős–Rényi graphs.
+        std::mt19937_64 random(kSeed + 1);
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> pairs(kPairCount);
+        for (auto &[src, dst]: pairs) {
+            src = random() % vertex_count;
+            dst = random() % vertex_count;
+        }
+        return pairs;
+    }
+
+    // The graph selected by the arguments of the benchmark: the strategy, the shape, the number of vertices and,
+    // if layout_argument is true, the adjacency layout. The default layout is used otherwise.
+    struct BenchGraph {
+        graph_store::GraphStore::Strategy strategy;
+        std::uint64_t vertex_count;
+        std::vector<graph_util::Edge> edges;
+        graph_store::GraphStore::AdjacencyLayout layout = graph_store::GraphStore::Options().layout;
+
+        explicit BenchGraph(benchmark::State &state, const bool layout_argument = false) :
+                strategy(kStrategies[state.range(0)]),
+                vertex_count(std::uint64_t(state.range(2))),
+                edges(GenerateEdges(GraphShape(state.range(1)), vertex_count)) {
+            std::string label = std::string(kStrategyNames[state.range(0)]) + "/" + kShapeNames[state.range(1)];
+            if (layout_argument) {
+                layout = kLayouts[state.range(3)];
+                label += std::string("/") + kLayoutNames[state.range(3)];
+            }
+            state.SetLabel(label);
+            state.counters["edges"] = double(edges.size());
+        }
+
+        // Loads the graph, with kLabel set on all vertices if labelled is true.
+        graph_store::GraphStore Load(const bool labelled) const {
+            std::unordered_map<graph_util::Label, graph_util::VertexSet> label_to_vertices;
+            if (labelled) {
+                auto &vertices = label_to_vertices[kLabel];
+                for (std::uint64_t v = 0; v < vertex_count; ++v) {
+                    vertices.insert(v);
+                }
+            }
+            graph_store::GraphStore::Options options;
+            options.strategy = strategy;
+            options.layout = layout;
+            return {vertex_count, label_to_vertices, edges, options};
+        }
+    };
+
+    void BM_CreateVertex(benchmark::State &state) {
+        const BenchGraph graph(state);
+        auto gs = graph.Load(false);
+        for (auto _: state) {
+            benchmark::DoNotOptimize(gs.CreateVertex());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_CreateEdge(benchmark::State &state) {
+        const BenchGraph graph(state);
+        auto gs = graph.Load(false);
+        const auto pairs = GeneratePairs(graph.vertex_count);
+        std::size_t i = 0;
+        for (auto _: state) {
+            const auto &[src, dst] = pairs[i++ % kPairCount];
+            benchmark::DoNotOptimize(gs.CreateEdge(src, dst));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Labels the vertices one by one. Once all of them are labelled, the labels are removed outside of the timing.
+    void BM_AddLabel(benchmark::State &state) {
+        const BenchGraph graph(state);
+        auto gs = graph.Load(false);
+        std::uint64_t v = 0;
+        for (auto _: state) {
+            if (v == graph.vertex_count) {
+                state.PauseTiming();
+                for (v = 0; v < graph.vertex_count; ++v) {
+                    gs.RemoveLabel(v, kLabel);
+                }
+                v = 0;
+                state.ResumeTiming();
+            }
+            benchmark::DoNotOptimize(gs.AddLabel(v++, kLabel));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Unlabels the vertices one by one. Once none of them is labelled, the labels are added outside of the timing.
+    void BM_RemoveLabel(benchmark::State &state) {
+        const BenchGraph graph(state);
+        auto gs = graph.Load(true);
+        std::uint64_t v = 0;
+        for (auto _: state) {
+            if (v == graph.vertex_count) {
+                state.PauseTiming();
+                for (v = 0; v < graph.vertex_count; ++v) {
+                    gs.AddLabel(v, kLabel);
+                }
+                v = 0;
+                state.ResumeTiming();
+            }
+            benchmark::DoNotOptimize(gs.RemoveLabel(v++, kLabel));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Reports the adjacency bytes of the layout next to the search time, for the memory and time tradeoff.
+    void BM_ShortestPath(benchmark::State &state) {
+        const BenchGraph graph(state, true);
+        const auto gs = graph.Load(true);
+        state.counters["adjacency_bytes"] = double(gs.MemoryUsage().adjacency);
+        const auto pairs = GeneratePairs(graph.vertex_count);
+        std::size_t i = 0;
+        for (auto _: state) {
+            const auto &[src, dst] = pairs[i++ % kPairCount];
+            benchmark::DoNotOptimize(gs.ShortestPath(src, dst, kLabel));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Every strategy on every shape, with 2^10, 2^14 and 2^17 vertices.
+    void GraphArguments(benchmark::internal::Benchmark *benchmark) {
+        benchmark->ArgNames({"strategy", "shape", "vertices"});
+        benchmark->ArgsProduct({{0, 1, 2}, {0, 1, 2, 3}, {1 << 10, 1 << 14, 1 << 17}});
+    }
+
+    // The arguments of GraphArguments with every layout of kLayouts.
+    void LayoutGraphArguments(benchmark::internal::Benchmark *benchmark) {
+        benchmark->ArgNames({"strategy", "shape", "vertices", "layout"});
+        benchmark->ArgsProduct({{0, 1, 2}, {0, 1, 2, 3}, {1 << 10, 1 << 14, 1 << 17}, {0, 1, 2}});
+    }
+
+} // namespace
+
+BENCHMARK(BM_CreateVertex)->Apply(GraphArguments);
+BENCHMARK(BM_CreateEdge)->Apply(GraphArguments);
+BENCHMARK(BM_AddLabel)->Apply(GraphArguments);
+BENCHMARK(BM_RemoveLabel)->Apply(GraphArguments);
+BENCHMARK(BM_ShortestPath)->Apply(LayoutGraphArguments);
@@ -1,111 +1,998 @@
 #include "graph_store.hpp"
+#include "util/edge_list_file.hpp"
+#include "util/snapshot_file.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
 #include <queue>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace graph_store {
 
+    namespace {
+
+        // Returns the default options with the strategy set.
+        GraphStore::Options strategyOptions(const GraphStore::Strategy strategy) {
+            GraphStore::Options options;
+            options.strategy = strategy;
+            return options;
+        }
+
+    } // namespace
+
     GraphStore::GraphStore() : GraphStore(Strategy::OPTIMIZED_PERFORMANCE) {
         // Use optimized performance VertexState by default.
     }
 
-    GraphStore::GraphStore(const Strategy strategy) {
-        if (strategy == Strategy::OPTIMIZED_MEMORY) {
-            vertex_state_ = new graph_util::OptimizedMemoryVertexState;
-        } else if (strategy == Strategy::OPTIMIZED_PERFORMANCE) {
-            vertex_state_ = new graph_util::OptimizedPerformanceVertexState;
+    GraphStore::GraphStore(const Strategy strategy) : GraphStore(strategyOptions(strategy)) {
+    }
+
+    GraphStore::GraphStore(const Options &options) : GraphStore(options, true) {
+    }
+
+    GraphStore::GraphStore(const Options &options, const bool open_log) :
+            graph_(std::make_shared<graph_util::LabelledGraph>()),
+            search_states_(std::make_shared<SearchStatePool>()),
+            options_(options) {
+        if ((options.search == SearchAlgorithm::BIDIRECTIONAL_BFS ||
+             options.search == SearchAlgorithm::DIRECTION_OPTIMIZING_BFS) && !options.store_in_edges) {
+            throw std::invalid_argument("The search algorithm requires in-edges.");
+        }
+        if (options.layout == AdjacencyLayout::CONCURRENT && options.label_masks) {
+            // The mask vector would be reallocated by the concurrent CreateVertex calls.
+            throw std::invalid_argument("The label masks are not supported with the concurrent layout.");
+        }
+
+        if (options.search == SearchAlgorithm::PARALLEL_BFS) {
+            thread_pool_ = std::make_shared<graph_util::ThreadPool>(options.thread_count);
+        }
+        if (options.metrics) {
+            metrics_ = std::make_shared<graph_util::MetricsRegistry>();
+        }
+
+        graph_->neighbours = createAdjacency(0, {}, false, nullptr);
+        if (options.store_in_edges) {
+            graph_->in_neighbours = createAdjacency(0, {}, true, nullptr);
+        }
+
+        if (options.label_masks) {
+            graph_->label_masks.emplace();
+        }
+
+        if (open_log && !options.wal_path.empty()) {
+            openLog(0);
         }
     }
 
     GraphStore::GraphStore(const std::uint64_t vertex_count,
                            const std::unordered_map<graph_util::Label, graph_util::VertexSet> &label_to_vertices,
                            const std::vector<graph_util::Edge> &edges,
-                           const Strategy strategy) : GraphStore(strategy) {
+                           const Strategy strategy) : GraphStore(vertex_count, label_to_vertices, edges,
+                                                                 strategyOptions(strategy)) {
+    }
+
+    GraphStore::GraphStore(const std::uint64_t vertex_count,
+                           const std::unordered_map<graph_util::Label, graph_util::VertexSet> &label_to_vertices,
+                           const std::vector<graph_util::Edge> &edges,
+                           const Options &options) : GraphStore(options, false) {
+        if (!options.wal_path.empty()) {
+            throw std::invalid_argument("The bulk load is not logged, open a saved snapshot with the log instead.");
+        }
+
+        if (vertex_count > graph_util::kMaxVertexCount) {
+            throw std::invalid_argument("The number of vertices exceeds the width of the vertex IDs.");
+        }
+        for (const auto edge: edges) {
+            if (edge.source_vertex >= vertex_count || edge.destination_vertex >= vertex_count) {
+                throw std::invalid_argument("Failed to populate edges.");
+            }
+        }
 
-        for (int i = 0; i < vertex_count; i++) {
-            CreateVertex();
+        // Build the adjacencies at once instead of one insertion per vertex and edge, for CSR based layouts on all
+        // hardware threads.
+        std::unique_ptr<graph_util::ThreadPool> build_pool;
+        graph_util::ThreadPool *thread_pool = thread_pool_.get();
+        if (thread_pool == nullptr && edges.size() >= graph_util::CsrAdjacency::kParallelBuildThreshold &&
+            (options.layout == AdjacencyLayout::CSR || options.layout == AdjacencyLayout::DELTA_CSR ||
+             options.layout == AdjacencyLayout::COMPRESSED_CSR)) {
+            build_pool = std::make_unique<graph_util::ThreadPool>(options.thread_count);
+            thread_pool = build_pool.get();
+        }
+        graph_->neighbours = createAdjacency(vertex_count, edges, false, thread_pool);
+        if (graph_->in_neighbours.has_value()) {
+            graph_->in_neighbours = createAdjacency(vertex_count, edges, true, thread_pool);
+        }
+        if (graph_->label_masks.has_value()) {
+            graph_->label_masks->assign(vertex_count, 0);
         }
 
         // Populate labels.
         for (const auto &[label, vertex_set]: label_to_vertices) {
+            const auto label_id = InternLabel(label);
             for (const auto vertex: vertex_set) {
-                if (!AddLabel(vertex, label)) {
+                if (!addLabel(vertex, label_id)) {
                     throw std::invalid_argument("Failed to populate labels.");
                 }
             }
         }
-
-        // Populate edges.
-        for (const auto edge: edges) {
-            if (!CreateEdge(edge.source_vertex, edge.destination_vertex)) {
-                throw std::invalid_argument("Failed to populate edges.");
-            }
-        }
     }
 
-    GraphStore::~GraphStore() {
-        delete vertex_state_;
+    GraphStore::GraphStore(std::shared_ptr<graph_util::LabelledGraph> graph, const Options &options,
+                           std::shared_ptr<graph_util::ThreadPool> thread_pool,
+                           std::shared_ptr<SearchStatePool> search_states,
+                           std::shared_ptr<graph_util::MetricsRegistry> metrics) :
+            graph_(std::move(graph)),
+            thread_pool_(std::move(thread_pool)),
+            search_states_(std::move(search_states)),
+            options_(options),
+            metrics_(std::move(metrics)) {
     }
 
+    GraphStore::~GraphStore() = default;
+
     std::uint64_t GraphStore::CreateVertex() {
-        std::uint64_t id = graph_.neighbours.size();
-        graph_.neighbours.emplace_back();
-        vertex_state_->ProcessVertexAddition();
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::CREATE_VERTEX);
+        return createVertex();
+    }
+
+    std::uint64_t GraphStore::createVertex() {
+        if (options_.layout == AdjacencyLayout::CONCURRENT) {
+            const auto lock = lockForConcurrentInsertion();
+            const std::uint64_t id = addVertex(*graph_);
+            logModification(graph_util::WriteAheadLog::RecordType::CREATE_VERTEX, id);
+            return id;
+        }
+
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
+        const std::uint64_t id = addVertex(mutableGraph());
+        logModification(graph_util::WriteAheadLog::RecordType::CREATE_VERTEX, id);
         return id;
     }
 
     bool GraphStore::CreateEdge(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id) {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::CREATE_EDGE);
+        return createEdge(src_vertex_id, dst_vertex_id);
+    }
+
+    bool GraphStore::createEdge(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id) {
+        if (options_.layout == AdjacencyLayout::CONCURRENT) {
+            // The concurrent writers may replace graph_, so it's read under the lock only.
+            const auto lock = lockForConcurrentInsertion();
+            if (!vertexExists(src_vertex_id) || !vertexExists(dst_vertex_id)) {
+                return false;
+            }
+            addEdge(*graph_, src_vertex_id, dst_vertex_id);
+            logModification(graph_util::WriteAheadLog::RecordType::CREATE_EDGE, src_vertex_id, dst_vertex_id);
+            return true;
+        }
+
         if (!vertexExists(src_vertex_id) || !vertexExists(dst_vertex_id)) {
             return false;
         }
-        graph_.neighbours[src_vertex_id].push_back(dst_vertex_id);
+
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
+        addEdge(mutableGraph(), src_vertex_id, dst_vertex_id);
+        logModification(graph_util::WriteAheadLog::RecordType::CREATE_EDGE, src_vertex_id, dst_vertex_id);
         return true;
     }
 
     bool GraphStore::AddLabel(const std::uint64_t vertex_id, const graph_util::Label &label) {
-        if (!vertexExists(vertex_id)) {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::ADD_LABEL);
+        {
+            std::shared_lock<std::shared_mutex> lock(version_mutex_);
+            if (!vertexExists(vertex_id)) {
+                return false;
+            }
+        }
+        return addLabel(vertex_id, InternLabel(label));
+    }
+
+    bool GraphStore::AddLabel(const std::uint64_t vertex_id, const graph_util::LabelId label_id) {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::ADD_LABEL);
+        return addLabel(vertex_id, label_id);
+    }
+
+    bool GraphStore::addLabel(const std::uint64_t vertex_id, const graph_util::LabelId label_id) {
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
+        if (!vertexExists(vertex_id) || !graph_->labels.Contains(label_id)) {
             return false;
         }
-        graph_.label_to_vertices[label].insert(vertex_id);
+
+        auto &graph = mutableGraph();
+
+        if (graph.IsMaskedLabel(label_id)) {
+            (*graph.label_masks)[vertex_id] |= graph_util::LabelMask(1) << label_id;
+        } else {
+            graph.label_to_vertices[label_id].Insert(vertex_id);
+        }
+        logModification(graph_util::WriteAheadLog::RecordType::ADD_LABEL, vertex_id, label_id);
         return true;
     }
 
     bool GraphStore::RemoveLabel(const std::uint64_t vertex_id, const graph_util::Label &label) {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::REMOVE_LABEL);
+        std::optional<graph_util::LabelId> label_id;
+        {
+            std::shared_lock<std::shared_mutex> lock(version_mutex_);
+            if (!vertexExists(vertex_id)) {
+                return false;
+            }
+            label_id = graph_->labels.Find(label);
+        }
+
+        // The label that was never interned is not set to any vertex.
+        if (label_id.has_value()) {
+            return removeLabel(vertex_id, *label_id);
+        }
+
+        return true;
+    }
+
+    bool GraphStore::RemoveLabel(const std::uint64_t vertex_id, const graph_util::LabelId label_id) {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::REMOVE_LABEL);
+        return removeLabel(vertex_id, label_id);
+    }
+
+    bool GraphStore::removeLabel(const std::uint64_t vertex_id, const graph_util::LabelId label_id) {
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
         if (!vertexExists(vertex_id)) {
             return false;
         }
 
-        auto vertices_it = graph_.label_to_vertices.find(label);
-        if (vertices_it != graph_.label_to_vertices.end()) {
-            vertices_it->second.erase(vertex_id);
+        // The unknown label is not set to any vertex, leave the version shared with the snapshots.
+        if (!graph_->labels.Contains(label_id)) {
+            return true;
+        }
+
+        auto &graph = mutableGraph();
+
+        if (graph.IsMaskedLabel(label_id)) {
+            (*graph.label_masks)[vertex_id] &= ~(graph_util::LabelMask(1) << label_id);
+        } else {
+            graph.label_to_vertices[label_id].Erase(vertex_id);
         }
+        logModification(graph_util::WriteAheadLog::RecordType::REMOVE_LABEL, vertex_id, label_id);
 
         return true;
     }
 
+    graph_util::LabelId GraphStore::InternLabel(const graph_util::Label &label) {
+        // Resolving an already interned label does not modify the graph.
+        {
+            std::shared_lock<std::shared_mutex> lock(version_mutex_);
+            const auto existing_label_id = graph_->labels.Find(label);
+            if (existing_label_id.has_value()) {
+                return *existing_label_id;
+            }
+        }
+
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
+        auto &graph = mutableGraph();
+
+        // Intern returns the existing ID if another thread interned the label in the meantime.
+        const auto label_id = graph.labels.Intern(label);
+        if (label_id == graph.label_to_vertices.size()) {
+            graph.label_to_vertices.emplace_back();
+            // The IDs are assigned in the order of interning, so the replay assigns the same IDs again.
+            logModification(graph_util::WriteAheadLog::RecordType::INTERN_LABEL, 0, 0, label);
+        }
+        return label_id;
+    }
+
+    void GraphStore::SyncLog() {
+        if (wal_ != nullptr) {
+            wal_->Sync();
+        }
+    }
+
+    std::shared_ptr<const GraphStore> GraphStore::Snapshot() const {
+        if (options_.layout == AdjacencyLayout::CONCURRENT) {
+            throw std::logic_error("The snapshots are not supported with the concurrent layout.");
+        }
+
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
+        // The constructor is private, so std::make_shared can not be used.
+        auto *snapshot = new GraphStore(graph_, options_, thread_pool_, search_states_, metrics_);
+        // The snapshot does not log, but its saved files should still skip the log records it reflects.
+        snapshot->snapshot_sequence_number_ = wal_ != nullptr ? wal_->LastSequenceNumber() : snapshot_sequence_number_;
+        return std::shared_ptr<const GraphStore>(snapshot);
+    }
+
+    graph_util::StoreMetrics GraphStore::Metrics() const {
+        graph_util::StoreMetrics metrics;
+        if (metrics_ != nullptr) {
+            metrics.operations = metrics_->Collect();
+        }
+
+        // The exclusive lock keeps out the concurrent insertions of CONCURRENT layout, which hold it shared.
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
+        metrics.vertex_count = std::visit([](const auto &adjacency) { return adjacency.VertexCount(); },
+                                          graph_->neighbours);
+        metrics.edge_count = std::visit([](const auto &adjacency) { return adjacency.EdgeCount(); },
+                                        graph_->neighbours);
+        metrics.label_count = graph_->labels.Size();
+
+        const auto usage = memoryUsage();
+        metrics.memory_bytes = {{"adjacency", usage.adjacency}, {"label_index", usage.label_index},
+                                {"vertex_state", usage.vertex_state}, {"slack", usage.slack}};
+        return metrics;
+    }
+
+    graph_util::MemoryUsage GraphStore::MemoryUsage() const {
+        // The exclusive lock keeps out the concurrent insertions of CONCURRENT layout, which hold it shared.
+        std::lock_guard<std::shared_mutex> lock(version_mutex_);
+        return memoryUsage();
+    }
+
+    graph_util::MemoryUsage GraphStore::memoryUsage() const {
+        const auto adjacency_footprint = [](const graph_util::Adjacency &adjacency) {
+            return std::visit([](const auto &layout) { return layout.Footprint(); }, adjacency);
+        };
+        graph_util::MemoryFootprint adjacency = adjacency_footprint(graph_->neighbours);
+        if (graph_->in_neighbours.has_value()) {
+            adjacency += adjacency_footprint(*graph_->in_neighbours);
+        }
+
+        graph_util::MemoryFootprint label_index = graph_->labels.Footprint();
+        label_index.AddBuffer<graph_util::LabelMembership>(graph_->label_to_vertices.size(),
+                                                           graph_->label_to_vertices.capacity());
+        for (const auto &vertices: graph_->label_to_vertices) {
+            label_index += vertices.Footprint();
+        }
+        if (graph_->label_masks.has_value()) {
+            label_index.AddBuffer<graph_util::LabelMask>(graph_->label_masks->size(), graph_->label_masks->capacity());
+        }
+
+        graph_util::MemoryFootprint vertex_state;
+        {
+            std::lock_guard<std::mutex> lock(search_states_->mutex);
+            vertex_state.AddBuffer<std::unique_ptr<SearchState>>(search_states_->states.size(),
+                                                                 search_states_->states.capacity());
+            for (const auto &search_state: search_states_->states) {
+                vertex_state.AddBuffer<SearchState>(1, 1);
+                vertex_state += std::visit([](const auto &state) { return state.Footprint(); }, search_state->forward);
+                if (search_state->parents != nullptr) {
+                    vertex_state.AddBuffer<std::atomic<graph_util::VertexId>>(search_state->vertex_count,
+                                                                              search_state->parents_capacity);
+                }
+                if (search_state->backward.has_value()) {
+                    vertex_state += std::visit([](const auto &state) { return state.Footprint(); },
+                                               *search_state->backward);
+                }
+            }
+        }
+
+        graph_util::MemoryUsage usage;
+        usage.adjacency = adjacency.allocated - adjacency.slack;
+        usage.label_index = label_index.allocated - label_index.slack;
+        usage.vertex_state = vertex_state.allocated - vertex_state.slack;
+        usage.slack = adjacency.slack + label_index.slack + vertex_state.slack;
+        return usage;
+    }
+
+    void GraphStore::SaveSnapshot(const std::string &path) const {
+        // Hold the current version, the modifications then copy it instead of modifying it while it's written.
+        // The exclusive lock keeps out the concurrent insertions that already own the version.
+        std::shared_ptr<const graph_util::LabelledGraph> graph;
+        graph_util::SnapshotHeader header;
+        {
+            std::lock_guard<std::shared_mutex> lock(version_mutex_);
+            graph = graph_;
+            // Every modification is logged under the lock, so the version reflects exactly the records up to here.
+            header.sequence_number = wal_ != nullptr ? wal_->LastSequenceNumber() : snapshot_sequence_number_;
+        }
+
+        graph_util::SnapshotWriter writer(path);
+        header.vertex_count = std::visit([](const auto &adjacency) { return adjacency.VertexCount(); },
+                                         graph->neighbours);
+        header.edge_count = std::visit([](const auto &adjacency) { return adjacency.EdgeCount(); },
+                                       graph->neighbours);
+        header.label_count = graph->labels.Size();
+        if (sizeof(graph_util::VertexId) == sizeof(std::uint32_t)) {
+            header.flags |= graph_util::SnapshotHeader::kVertexIds32;
+        }
+
+        // Every layout is saved as CSR arrays.
+        const auto write_adjacency = [&writer, &header](const graph_util::Adjacency &adjacency,
+                                                        std::uint64_t &offsets_position,
+                                                        std::uint64_t &targets_position) {
+            std::visit([&](const auto &layout) {
+                offsets_position = writer.Position();
+                std::uint64_t offset = 0;
+                writer.WriteWord(offset);
+                for (std::uint64_t v = 0; v < header.vertex_count; ++v) {
+                    offset += layout.Degree(v);
+                    writer.WriteWord(offset);
+                }
+
+                targets_position = writer.Position();
+                for (std::uint64_t v = 0; v < header.vertex_count; ++v) {
+                    layout.ForEachNeighbour(v, [&writer](const std::uint64_t neighbour) {
+                        writer.WriteVertexId(graph_util::VertexId(neighbour));
+                        return true;
+                    });
+                }
+                writer.PadToWord();
+            }, adjacency);
+        };
+
+        write_adjacency(graph->neighbours, header.out_offsets_position, header.out_targets_position);
+        if (graph->in_neighbours.has_value()) {
+            header.flags |= graph_util::SnapshotHeader::kHasInEdges;
+            write_adjacency(*graph->in_neighbours, header.in_offsets_position, header.in_targets_position);
+        }
+
+        header.labels_position = writer.Position();
+        graph_util::VertexVector vertices;
+        for (graph_util::LabelId label_id = 0; label_id < header.label_count; ++label_id) {
+            vertices.clear();
+            if (graph->IsMaskedLabel(label_id)) {
+                for (std::uint64_t v = 0; v < header.vertex_count; ++v) {
+                    if (((*graph->label_masks)[v] >> label_id) & 1) {
+                        vertices.push_back(v);
+                    }
+                }
+            } else {
+                graph->label_to_vertices[label_id].Visit([&vertices](const auto &bitmap) {
+                    bitmap.ForEach([&vertices](const std::uint64_t vertex) { vertices.push_back(vertex); });
+                });
+            }
+
+            const auto &label = graph->labels.GetLabel(label_id);
+            writer.WriteWord(label.size());
+            writer.WriteWord(vertices.size());
+            writer.WriteBytes(label);
+            for (const auto vertex: vertices) {
+                writer.WriteWord(vertex);
+            }
+        }
+
+        writer.Finish(header);
+    }
+
+    std::unique_ptr<GraphStore> GraphStore::OpenSnapshot(const std::string &path) {
+        Options options;
+        options.layout = AdjacencyLayout::CSR;
+        return OpenSnapshot(path, options);
+    }
+
+    std::unique_ptr<GraphStore> GraphStore::OpenSnapshot(const std::string &path, const Options &options) {
+        auto file = std::make_shared<const graph_util::MappedFile>(path);
+
+        graph_util::SnapshotHeader header;
+        if (file->Size() < sizeof(header)) {
+            throw std::runtime_error("The file " + path + " is not a Graph Store snapshot.");
+        }
+        std::memcpy(&header, file->Data(), sizeof(header));
+        if (header.magic != graph_util::SnapshotHeader::kMagic) {
+            throw std::runtime_error("The file " + path + " is not a Graph Store snapshot.");
+        }
+        if (header.version != graph_util::SnapshotHeader::kVersion) {
+            throw std::runtime_error("The snapshot " + path + " has unsupported version " +
+                                     std::to_string(header.version) + ".");
+        }
+        if (header.file_size != file->Size()) {
+            throw std::runtime_error("The snapshot " + path + " is truncated.");
+        }
+        // The targets are read in place, so they should be stored in the width of this build.
+        const bool vertex_ids_32 = (header.flags & graph_util::SnapshotHeader::kVertexIds32) != 0;
+        if (vertex_ids_32 != (sizeof(graph_util::VertexId) == sizeof(std::uint32_t))) {
+            throw std::runtime_error("The snapshot " + path + " is saved with " + (vertex_ids_32 ? "32" : "64") +
+                                     "-bit vertex IDs, which this build does not store.");
+        }
+
+        // Returns the words of a section, checking that they lie within the file. The contents of the CSR arrays are
+        // not checked, that would read the whole file.
+        const auto words = [&file, &path](const std::uint64_t position, const std::uint64_t count) {
+            if (position % sizeof(std::uint64_t) != 0 || position > file->Size() ||
+                count > (file->Size() - position) / sizeof(std::uint64_t)) {
+                throw std::runtime_error("The snapshot " + path + " is corrupted.");
+            }
+            return reinterpret_cast<const std::uint64_t *>(file->Data() + position);
+        };
+        const std::uint64_t vertex_count = header.vertex_count;
+        if (vertex_count > graph_util::kMaxVertexCount || vertex_count == std::numeric_limits<std::uint64_t>::max()) {
+            throw std::runtime_error("The snapshot " + path + " is corrupted.");
+        }
+        const auto mapped_csr = [&](const std::uint64_t offsets_position, const std::uint64_t targets_position) {
+            const std::uint64_t *offsets = words(offsets_position, vertex_count + 1);
+            if (offsets[0] != 0 || offsets[vertex_count] != header.edge_count) {
+                throw std::runtime_error("The snapshot " + path + " is corrupted.");
+            }
+            if (header.edge_count > file->Size()) {
+                throw std::runtime_error("The snapshot " + path + " is corrupted.");
+            }
+            const std::uint64_t target_words = (header.edge_count * sizeof(graph_util::VertexId) +
+                                                sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+            const auto *targets = reinterpret_cast<const graph_util::VertexId *>(
+                    words(targets_position, target_words));
+            return graph_util::CsrAdjacency(file, offsets, vertex_count, targets);
+        };
+
+        // The log is replayed once the snapshot is loaded. The constructor is private, so std::make_unique can not be
+        // used.
+        std::unique_ptr<GraphStore> store(new GraphStore(options, false));
+        store->snapshot_sequence_number_ = header.sequence_number;
+        auto &graph = *store->graph_;
+
+        auto out_csr = mapped_csr(header.out_offsets_position, header.out_targets_position);
+        if (graph.in_neighbours.has_value()) {
+            if ((header.flags & graph_util::SnapshotHeader::kHasInEdges) != 0) {
+                graph.in_neighbours = store->adjacencyFromCsr(
+                        mapped_csr(header.in_offsets_position, header.in_targets_position), store->thread_pool_.get());
+            } else {
+                std::vector<graph_util::Edge> edges;
+                edges.reserve(header.edge_count);
+                for (std::uint64_t v = 0; v < vertex_count; ++v) {
+                    out_csr.ForEachNeighbour(v, [&edges, v](const std::uint64_t neighbour) {
+                        edges.push_back({v, neighbour});
+                        return true;
+                    });
+                }
+                graph.in_neighbours = store->createAdjacency(vertex_count, edges, true, store->thread_pool_.get());
+            }
+        }
+        graph.neighbours = store->adjacencyFromCsr(std::move(out_csr), store->thread_pool_.get());
+        if (graph.label_masks.has_value()) {
+            graph.label_masks->assign(vertex_count, 0);
+        }
+
+        std::uint64_t position = header.labels_position;
+        for (std::uint64_t i = 0; i < header.label_count; ++i) {
+            const std::uint64_t *fields = words(position, 2);
+            const std::uint64_t label_size = fields[0];
+            const std::uint64_t member_count = fields[1];
+            position += 2 * sizeof(std::uint64_t);
+            if (label_size > file->Size()) {
+                throw std::runtime_error("The snapshot " + path + " is corrupted.");
+            }
+
+            const std::uint64_t label_words = (label_size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+            const auto *label_data = reinterpret_cast<const char *>(words(position, label_words));
+            position += label_words * sizeof(std::uint64_t);
+            const std::uint64_t *members = words(position, member_count);
+            position += member_count * sizeof(std::uint64_t);
+
+            // The labels are saved in the order of their IDs, so they get the same IDs again.
+            const auto label_id = graph.labels.Intern(graph_util::Label(label_data, label_size));
+            if (label_id == graph.label_to_vertices.size()) {
+                graph.label_to_vertices.emplace_back();
+            }
+            for (std::uint64_t j = 0; j < member_count; ++j) {
+                const std::uint64_t vertex = members[j];
+                if (vertex >= vertex_count) {
+                    throw std::runtime_error("The snapshot " + path + " is corrupted.");
+                }
+                if (graph.IsMaskedLabel(label_id)) {
+                    (*graph.label_masks)[vertex] |= graph_util::LabelMask(1) << label_id;
+                } else {
+                    graph.label_to_vertices[label_id].Insert(vertex);
+                }
+            }
+        }
+
+        if (!options.wal_path.empty()) {
+            store->openLog(header.sequence_number);
+        }
+        return store;
+    }
+
+    std::unique_ptr<GraphStore> GraphStore::LoadEdgeList(const std::string &edge_list_path,
+                                                         const std::string &labels_path, const Options &options) {
+        if (!options.wal_path.empty()) {
+            throw std::invalid_argument("The bulk load is not logged, open a saved snapshot with the log instead.");
+        }
+
+        // The constructor is private, so std::make_unique can not be used.
+        std::unique_ptr<GraphStore> store(new GraphStore(options, false));
+        auto &graph = *store->graph_;
+
+        const graph_util::EdgeListFile edge_list(edge_list_path);
+        std::optional<graph_util::LabelFile> label_file;
+        if (!labels_path.empty()) {
+            label_file.emplace(labels_path);
+        }
+
+        std::unique_ptr<graph_util::ThreadPool> load_pool;
+        graph_util::ThreadPool *thread_pool = store->thread_pool_.get();
+        if (thread_pool == nullptr) {
+            load_pool = std::make_unique<graph_util::ThreadPool>(options.thread_count);
+            thread_pool = load_pool.get();
+        }
+
+        graph_util::LabelFile::Contents labels;
+        if (label_file.has_value()) {
+            labels = label_file->Read(*thread_pool);
+        }
+        const std::uint64_t vertex_count = std::max(edge_list.VertexCount(*thread_pool), labels.vertex_count);
+
+        graph_util::CsrAdjacency out_csr;
+        std::optional<graph_util::CsrAdjacency> in_csr;
+        if (graph.in_neighbours.has_value()) {
+            in_csr.emplace();
+        }
+        edge_list.BuildCsr(vertex_count, *thread_pool, out_csr, in_csr.has_value() ? &*in_csr : nullptr);
+        graph.neighbours = store->adjacencyFromCsr(std::move(out_csr), thread_pool);
+        if (in_csr.has_value()) {
+            graph.in_neighbours = store->adjacencyFromCsr(std::move(*in_csr), thread_pool);
+        }
+        if (graph.label_masks.has_value()) {
+            graph.label_masks->assign(vertex_count, 0);
+        }
+
+        for (auto &label_vertices: labels.labels) {
+            const auto label_id = graph.labels.Intern(graph_util::Label(label_vertices.label));
+            graph.label_to_vertices.emplace_back();
+            for (const auto vertex: label_vertices.vertices) {
+                if (graph.IsMaskedLabel(label_id)) {
+                    (*graph.label_masks)[vertex] |= graph_util::LabelMask(1) << label_id;
+                } else {
+                    graph.label_to_vertices[label_id].Insert(vertex);
+                }
+            }
+            // Release the vertices of the label once they are in the index.
+            label_vertices.vertices = graph_util::VertexVector();
+        }
+        return store;
+    }
+
     std::optional<graph_util::Path>
     GraphStore::ShortestPath(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id,
-                             const graph_util::Label &label) {
+                             const graph_util::Label &label) const {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::SHORTEST_PATH);
+        const auto label_id = graph_->labels.Find(label);
+
+        // If the label was never interned, it is not set to any vertex and we can immediately return.
+        if (!label_id.has_value()) {
+            return std::nullopt;
+        }
+
+        graph_util::NoQueryStatsRecorder recorder;
+        return shortestPath(src_vertex_id, dst_vertex_id, *label_id, recorder);
+    }
+
+    template<typename Visitor>
+    decltype(auto) GraphStore::visitLabelFilter(const graph_util::LabelId label_id, Visitor &&visitor) const {
+        if (graph_->IsMaskedLabel(label_id)) {
+            return visitor(graph_util::LabelMaskFilter(graph_->label_masks->data(), label_id));
+        }
+        return graph_->label_to_vertices[label_id].Visit(std::forward<Visitor>(visitor));
+    }
+
+    std::optional<graph_util::Path>
+    GraphStore::ShortestPath(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id,
+                             const graph_util::LabelId label_id) const {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::SHORTEST_PATH);
+        graph_util::NoQueryStatsRecorder recorder;
+        return shortestPath(src_vertex_id, dst_vertex_id, label_id, recorder);
+    }
+
+    std::optional<graph_util::Path>
+    GraphStore::ShortestPath(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id,
+                             const graph_util::Label &label, graph_util::QueryStats &stats) const {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::SHORTEST_PATH);
+        graph_util::QueryStatsRecorder recorder;
+        const auto label_id = graph_->labels.Find(label);
+        if (!label_id.has_value()) {
+            stats = recorder.Stats();
+            return std::nullopt;
+        }
+
+        auto path = shortestPath(src_vertex_id, dst_vertex_id, *label_id, recorder);
+        stats = recorder.Stats();
+        return path;
+    }
+
+    std::optional<graph_util::Path>
+    GraphStore::ShortestPath(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id,
+                             const graph_util::LabelId label_id, graph_util::QueryStats &stats) const {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::SHORTEST_PATH);
+        graph_util::QueryStatsRecorder recorder;
+        auto path = shortestPath(src_vertex_id, dst_vertex_id, label_id, recorder);
+        stats = recorder.Stats();
+        return path;
+    }
+
+    template<typename Recorder>
+    std::optional<graph_util::Path>
+    GraphStore::shortestPath(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id,
+                             const graph_util::LabelId label_id, Recorder &recorder) const {
         // Return if one or both vertices do not exist.
         if (!vertexExists(src_vertex_id) || !vertexExists(dst_vertex_id)) {
-            return resetVertexStateAndReturn(std::nullopt);
+            return std::nullopt;
+        }
+
+        // If the label ID is unknown, the label is not set to any vertex and we can immediately return.
+        if (!graph_->labels.Contains(label_id)) {
+            return std::nullopt;
+        }
+
+        recorder.StartTimer();
+        // Every call searches with its own scratch state, so the concurrent calls do not share any mutable data.
+        auto search_state = acquireSearchState();
+        std::optional<graph_util::Path> path;
+
+        if (options_.search == SearchAlgorithm::PARALLEL_BFS) {
+            path = visitLabelFilter(label_id, [&](const auto &valid_vertices) {
+                if (!valid_vertices.Contains(src_vertex_id) || !valid_vertices.Contains(dst_vertex_id)) {
+                    return std::optional<graph_util::Path>();
+                }
+
+                return std::visit([&](const auto &adjacency) {
+                    return parallelSearch(adjacency, *search_state, src_vertex_id, dst_vertex_id, valid_vertices,
+                                          recorder);
+                }, graph_->neighbours);
+            });
+
+            releaseSearchState(std::move(search_state));
+            return path;
         }
 
-        const auto labeled_vertices_pair = graph_.label_to_vertices.find(label);
+        if (options_.search == SearchAlgorithm::BIDIRECTIONAL_BFS) {
+            // Resolve the layouts and the label representation once, as for the one-directional search below.
+            const auto meeting_vertex = visitLabelFilter(label_id, [&](const auto &valid_vertices) {
+                if (!valid_vertices.Contains(src_vertex_id) || !valid_vertices.Contains(dst_vertex_id)) {
+                    return std::optional<std::uint64_t>();
+                }
+
+                return std::visit([&](const auto &out_adjacency, auto &state) {
+                    // Incoming edges and the backward state have the same types as the outgoing edges and the state.
+                    const auto &in_adjacency = std::get<std::decay_t<decltype(out_adjacency)>>(*graph_->in_neighbours);
+                    auto &backward_state = std::get<std::decay_t<decltype(state)>>(*search_state->backward);
+                    return bidirectionalSearch(out_adjacency, in_adjacency, state, backward_state, src_vertex_id,
+                                               dst_vertex_id, valid_vertices, recorder);
+                }, graph_->neighbours, search_state->forward);
+            });
+            recorder.Lap(graph_util::QueryPhase::SEARCH);
+
+            if (meeting_vertex.has_value()) {
+                // Join the forward path to the meeting vertex with the reversed backward path from the destination.
+                path = std::visit([&](auto &state) {
+                    return state.FindPath(src_vertex_id, *meeting_vertex);
+                }, search_state->forward);
+                const auto backward_path = std::visit([&](auto &state) {
+                    return state.FindPath(dst_vertex_id, *meeting_vertex);
+                }, *search_state->backward);
+                path->vertices.insert(path->vertices.end(), backward_path.vertices.rbegin() + 1,
+                                      backward_path.vertices.rend());
+                path->length += backward_path.length;
+                recorder.Lap(graph_util::QueryPhase::PATH);
+            }
+
+            releaseSearchState(std::move(search_state));
+            recorder.Lap(graph_util::QueryPhase::RESET);
+            return path;
+        }
+
+        // Resolve the adjacency layout, the vertex state and the label representation once, so that the search loop
+        // is compiled for the concrete types.
+        const bool reached_dst_vertex = visitLabelFilter(label_id, [&](const auto &valid_vertices) {
+            // if the source or destination vertices do not have the specified label, labelled path does not exist
+            // between them.
+            if (!valid_vertices.Contains(src_vertex_id) || !valid_vertices.Contains(dst_vertex_id)) {
+                return false;
+            }
+
+            return std::visit([&](const auto &adjacency, auto &state) {
+                if (options_.search == SearchAlgorithm::DIRECTION_OPTIMIZING_BFS) {
+                    const auto &in_adjacency = std::get<std::decay_t<decltype(adjacency)>>(*graph_->in_neighbours);
+                    return directionOptimizingSearch(adjacency, in_adjacency, state, src_vertex_id, dst_vertex_id,
+                                                     valid_vertices, recorder);
+                }
+                return breadthFirstSearch(adjacency, state, src_vertex_id, dst_vertex_id, valid_vertices, recorder);
+            }, graph_->neighbours, search_state->forward);
+        });
+        recorder.Lap(graph_util::QueryPhase::SEARCH);
+
+        if (reached_dst_vertex) {
+            path = std::visit([&](auto &state) { return state.FindPath(src_vertex_id, dst_vertex_id); },
+                              search_state->forward);
+            recorder.Lap(graph_util::QueryPhase::PATH);
+        }
+
+        releaseSearchState(std::move(search_state));
+        recorder.Lap(graph_util::QueryPhase::RESET);
+        return path;
+    }
+
+    std::vector<std::optional<graph_util::Path>>
+    GraphStore::ShortestPathBatch(const std::vector<Query> &queries) const {
+        const graph_util::OperationTimer timer(metrics_.get(), graph_util::Operation::SHORTEST_PATH_BATCH);
+        std::vector<std::optional<graph_util::Path>> paths(queries.size());
+
+        // Group the queries by label, the queries with unknown vertices or labels have no path.
+        std::unordered_map<graph_util::LabelId, std::vector<std::size_t>> label_to_queries;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            const auto &query = queries[i];
+            if (!vertexExists(query.src_vertex_id) || !vertexExists(query.dst_vertex_id)) {
+                continue;
+            }
+            const auto label_id = graph_->labels.Find(query.label);
+            if (label_id.has_value()) {
+                label_to_queries[*label_id].push_back(i);
+            }
+        }
+
+        // Shared by all batches of the call, so the O(V) masks are allocated once.
+        BatchMasks masks;
+        for (const auto &[label_id, query_indices]: label_to_queries) {
+            visitLabelFilter(label_id, [&](const auto &valid_vertices) {
+                std::vector<std::size_t> batch;
+                const auto run_batch = [&]() {
+                    std::visit([&](const auto &adjacency) {
+                        multiSourceSearch(adjacency, queries, batch, valid_vertices, masks, paths);
+                    }, graph_->neighbours);
+                    batch.clear();
+                };
+
+                for (const auto i: query_indices) {
+                    if (!valid_vertices.Contains(queries[i].src_vertex_id) ||
+                        !valid_vertices.Contains(queries[i].dst_vertex_id)) {
+                        continue;
+                    }
+                    batch.push_back(i);
+                    if (batch.size() == kBatchWidth) {
+                        run_batch();
+                    }
+                }
+                if (!batch.empty()) {
+                    run_batch();
+                }
+            });
+        }
+
+        return paths;
+    }
+
+    template<typename Adjacency, typename LabelFilter>
+    void GraphStore::multiSourceSearch(const Adjacency &adjacency, const std::vector<Query> &queries,
+                                       const std::vector<std::size_t> &batch, const LabelFilter &valid_vertices,
+                                       BatchMasks &masks, std::vector<std::optional<graph_util::Path>> &paths) const {
+        using QueryMask = std::uint64_t;
+        constexpr std::uint64_t unreachable = std::numeric_limits<std::uint64_t>::max();
 
-        // If the label is not set to any vertex, we can immediately return.
-        if (labeled_vertices_pair == graph_.label_to_vertices.end()) {
-            return resetVertexStateAndReturn(std::nullopt);
+        // The vertex discovered from the parent by the searches in the queries mask.
+        struct Discovery {
+            std::uint64_t vertex;
+            std::uint64_t parent;
+            QueryMask queries;
+        };
+
+        // The new entries are zeroed, the earlier batches zeroed the others.
+        const std::uint64_t vertex_count = adjacency.VertexCount();
+        if (masks.seen.size() < vertex_count) {
+            masks.seen.resize(vertex_count, 0);
+            masks.frontier.resize(vertex_count, 0);
+            masks.next.resize(vertex_count, 0);
         }
+        auto &seen = masks.seen;
+        auto &frontier_masks = masks.frontier;
+        auto &next_masks = masks.next;
+
+        // The vertices with non-zero frontier masks.
+        graph_util::VertexVector frontier;
+        graph_util::VertexVector next_frontier;
+
+        std::vector<std::uint64_t> distances(batch.size(), unreachable);
+
+        // The searches that did not reach their destination yet.
+        QueryMask active = 0;
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            const auto &query = queries[batch[i]];
+            const QueryMask bit = QueryMask(1) << i;
+            if (frontier_masks[query.src_vertex_id] == 0) {
+                frontier.push_back(query.src_vertex_id);
+            }
+            frontier_masks[query.src_vertex_id] |= bit;
+            seen[query.src_vertex_id] |= bit;
+
+            if (query.src_vertex_id == query.dst_vertex_id) {
+                distances[i] = 0;
+            } else {
+                active |= bit;
+            }
+        }
+
+        // levels[d] holds the discoveries at distance d, levels[0] is empty.
+        std::vector<std::vector<Discovery>> levels(1);
+
+        for (std::uint64_t distance = 1; active != 0 && !frontier.empty(); ++distance) {
+            auto &discoveries = levels.emplace_back();
 
-        const auto &valid_vertices = labeled_vertices_pair->second;
+            next_frontier.clear();
+            for (const std::uint64_t curr_vertex: frontier) {
+                const QueryMask curr_mask = frontier_masks[curr_vertex] & active;
+                frontier_masks[curr_vertex] = 0;
+                if (curr_mask == 0) {
+                    continue;
+                }
 
-        // if the source or destination vertices do not have the specified label, labelled path does not exist between them.
-        if (valid_vertices.count(src_vertex_id) == 0 || valid_vertices.count(dst_vertex_id) == 0) {
-            return resetVertexStateAndReturn(std::nullopt);
+                adjacency.ForEachNeighbour(curr_vertex, [&](const std::uint64_t neighbour) {
+                    const QueryMask new_mask = curr_mask & ~seen[neighbour];
+                    if (new_mask == 0 || !valid_vertices.Contains(neighbour)) {
+                        return true;
+                    }
+
+                    if (next_masks[neighbour] == 0) {
+                        next_frontier.push_back(neighbour);
+                    }
+                    next_masks[neighbour] |= new_mask;
+                    seen[neighbour] |= new_mask;
+                    discoveries.push_back({neighbour, curr_vertex, new_mask});
+                    return true;
+                });
+            }
+
+            for (QueryMask bits = active; bits != 0; bits &= bits - 1) {
+                const std::size_t i = __builtin_ctzll(bits);
+                if ((seen[queries[batch[i]].dst_vertex_id] >> i) & 1) {
+                    distances[i] = distance;
+                    active &= ~(QueryMask(1) << i);
+                }
+            }
+
+            frontier.swap(next_frontier);
+            std::swap(frontier_masks, next_masks);
         }
 
-        vertex_state_->SetDistance(src_vertex_id, 0);
+        // Zero the masks for the next batch. The expansion zeroed the frontier masks of every expanded vertex, so
+        // only the unexpanded frontier is left in them, and seen is set only at the sources and the discoveries.
+        for (const std::uint64_t vertex: frontier) {
+            frontier_masks[vertex] = 0;
+        }
+        for (const std::size_t i: batch) {
+            seen[queries[i].src_vertex_id] = 0;
+        }
+        for (const auto &discoveries: levels) {
+            for (const auto &discovery: discoveries) {
+                seen[discovery.vertex] = 0;
+            }
+        }
+
+        // Walk the levels backwards, current[i] is the vertex of the i-th path at the current level.
+        std::vector<std::uint64_t> current(batch.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            if (distances[i] == unreachable) {
+                continue;
+            }
+            const std::uint64_t dst_vertex_id = queries[batch[i]].dst_vertex_id;
+            paths[batch[i]] = graph_util::Path{distances[i], graph_util::VertexVector(distances[i] + 1, dst_vertex_id)};
+            current[i] = dst_vertex_id;
+        }
+
+        // The searches whose paths pass through the current level.
+        QueryMask pending = 0;
+        for (std::uint64_t distance = levels.size() - 1; distance > 0; --distance) {
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                if (distances[i] == distance) {
+                    pending |= QueryMask(1) << i;
+                }
+            }
+
+            QueryMask unresolved = pending;
+            for (const auto &discovery: levels[distance]) {
+                for (QueryMask bits = discovery.queries & unresolved; bits != 0; bits &= bits - 1) {
+                    const std::size_t i = __builtin_ctzll(bits);
+                    if (current[i] == discovery.vertex) {
+                        current[i] = discovery.parent;
+                        paths[batch[i]]->vertices[distance - 1] = discovery.parent;
+                        unresolved &= ~(QueryMask(1) << i);
+                    }
+                }
+            }
+        }
+    }
+
+    template<typename Adjacency, typename State, typename LabelFilter, typename Recorder>
+    bool GraphStore::breadthFirstSearch(const Adjacency &adjacency, State &state, const std::uint64_t src_vertex_id,
+                                        const std::uint64_t dst_vertex_id, const LabelFilter &valid_vertices,
+                                        Recorder &recorder) const {
+        state.SetDistance(src_vertex_id, 0);
+        recorder.VertexTouched();
 
         // Queue for Breadth First Search.
         std::queue<std::uint64_t> vertex_queue;
@@ -117,47 +1004,643 @@ namespace graph_store {
         while (!vertex_queue.empty() && !reached_dst_vertex) {
             std::uint64_t curr_vertex = vertex_queue.front();
             vertex_queue.pop();
+            recorder.VertexDequeued();
 
-            for (const std::uint64_t neighbour: graph_.neighbours[curr_vertex]) {
-                if (valid_vertices.count(neighbour) == 0) {
-                    continue;
-                }
+            // The distance of the vertex does not change while its neighbours are scanned.
+            const std::uint64_t distance_to_curr = state.GetDistance(curr_vertex);
 
-                std::uint64_t distance_to_curr = vertex_state_->GetDistance(curr_vertex);
-                std::uint64_t distance_to_neighbour = vertex_state_->GetDistance(neighbour);
+            adjacency.ForEachNeighbour(curr_vertex, [&](const std::uint64_t neighbour) {
+                recorder.EdgeScanned();
+                if (!valid_vertices.Contains(neighbour)) {
+                    recorder.LabelRejected();
+                    return true;
+                }
 
+                std::uint64_t distance_to_neighbour = state.GetDistance(neighbour);
 
                 if (distance_to_neighbour > distance_to_curr + 1) {
-                    vertex_state_->SetDistance(neighbour, distance_to_curr + 1);
-                    vertex_state_->SetParent(neighbour, curr_vertex);
+                    state.SetDistance(neighbour, distance_to_curr + 1);
+                    state.SetParent(neighbour, curr_vertex);
                     vertex_queue.push(neighbour);
+                    recorder.VertexTouched();
+                    recorder.LevelReached(distance_to_curr + 1);
                 }
 
                 if (neighbour == dst_vertex_id) {
                     // If we reached the destination vertex, we can terminate BFS algorithm, because the shortest path
                     // is already found for the destination vertex.
                     reached_dst_vertex = true;
-                    break;
+                    return false;
+                }
+                return true;
+            });
+        }
+
+        return reached_dst_vertex;
+    }
+
+    template<typename Adjacency, typename State, typename LabelFilter, typename Recorder>
+    std::optional<std::uint64_t>
+    GraphStore::bidirectionalSearch(const Adjacency &out_adjacency, const Adjacency &in_adjacency,
+                                    State &forward_state, State &backward_state, const std::uint64_t src_vertex_id,
+                                    const std::uint64_t dst_vertex_id, const LabelFilter &valid_vertices,
+                                    Recorder &recorder) const {
+        constexpr std::uint64_t unreachable = std::numeric_limits<std::uint64_t>::max();
+
+        forward_state.SetDistance(src_vertex_id, 0);
+        backward_state.SetDistance(dst_vertex_id, 0);
+        recorder.VertexTouched();
+        recorder.VertexTouched();
+
+        // The depths of the forward and the backward searches.
+        std::uint64_t forward_depth = 0;
+        std::uint64_t backward_depth = 0;
+
+        if (src_vertex_id == dst_vertex_id) {
+            return src_vertex_id;
+        }
+
+        // The last discovered levels of the forward and the backward searches.
+        graph_util::VertexVector forward_frontier = {src_vertex_id};
+        graph_util::VertexVector backward_frontier = {dst_vertex_id};
+        graph_util::VertexVector next_frontier;
+
+        std::uint64_t best_length = unreachable;
+        std::uint64_t meeting_vertex = src_vertex_id;
+
+        while (!forward_frontier.empty() && !backward_frontier.empty()) {
+            const bool forward = forward_frontier.size() <= backward_frontier.size();
+            const Adjacency &adjacency = forward ? out_adjacency : in_adjacency;
+            State *state = forward ? &forward_state : &backward_state;
+            State *other_state = forward ? &backward_state : &forward_state;
+            graph_util::VertexVector &frontier = forward ? forward_frontier : backward_frontier;
+
+            next_frontier.clear();
+            for (const std::uint64_t curr_vertex: frontier) {
+                const std::uint64_t distance_to_curr = state->GetDistance(curr_vertex);
+                recorder.VertexDequeued();
+
+                adjacency.ForEachNeighbour(curr_vertex, [&](const std::uint64_t neighbour) {
+                    recorder.EdgeScanned();
+                    if (!valid_vertices.Contains(neighbour)) {
+                        recorder.LabelRejected();
+                        return true;
+                    }
+                    if (state->GetDistance(neighbour) != unreachable) {
+                        return true;
+                    }
+
+                    state->SetDistance(neighbour, distance_to_curr + 1);
+                    state->SetParent(neighbour, curr_vertex);
+                    next_frontier.push_back(neighbour);
+                    recorder.VertexTouched();
+
+                    const std::uint64_t distance_from_other = other_state->GetDistance(neighbour);
+                    if (distance_from_other != unreachable &&
+                        distance_to_curr + 1 + distance_from_other < best_length) {
+                        best_length = distance_to_curr + 1 + distance_from_other;
+                        meeting_vertex = neighbour;
+                    }
+                    return true;
+                });
+            }
+            frontier.swap(next_frontier);
+            ++(forward ? forward_depth : backward_depth);
+            recorder.LevelReached(forward_depth + backward_depth);
+
+            // No vertex was reached by both searches before this level, so every path is longer than the sum of
+            // the previous radii. The shortest connection found while expanding the whole level is therefore a
+            // shortest path.
+            if (best_length != unreachable) {
+                return meeting_vertex;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    template<typename Adjacency, typename State, typename LabelFilter, typename Recorder>
+    bool GraphStore::directionOptimizingSearch(const Adjacency &out_adjacency, const Adjacency &in_adjacency,
+                                               State &state, const std::uint64_t src_vertex_id,
+                                               const std::uint64_t dst_vertex_id,
+                                               const LabelFilter &valid_vertices, Recorder &recorder) const {
+        // Switch to bottom-up once the frontier edges exceed 1/kTopDownRatio of the unexplored edges, and back to
+        // top-down once the frontier holds less than 1/kBottomUpRatio of the vertices. The values are from
+        // Beamer et al., "Direction-Optimizing Breadth-First Search".
+        constexpr std::uint64_t kTopDownRatio = 14;
+        constexpr std::uint64_t kBottomUpRatio = 24;
+        constexpr std::uint64_t unreachable = std::numeric_limits<std::uint64_t>::max();
+
+        const std::uint64_t vertex_count = out_adjacency.VertexCount();
+
+        state.SetDistance(src_vertex_id, 0);
+        recorder.VertexTouched();
+        if (src_vertex_id == dst_vertex_id) {
+            return true;
+        }
+
+        // The bitmaps take O(V) time to allocate, so they are allocated by the first switch to bottom-up, whose steps
+        // scan all vertices anyway, and the queries answered top-down take time proportional to the explored edges.
+        // Until the switch the visited vertices are told by their distances and collected in discovered.
+        graph_util::DenseBitmap visited;
+        graph_util::VertexVector discovered = {src_vertex_id};
+        bool bitmaps_allocated = false;
+
+        // The frontier is a vertex list during the top-down steps and a bitmap during the bottom-up steps.
+        graph_util::VertexVector frontier = {src_vertex_id};
+        graph_util::VertexVector next_frontier;
+        graph_util::DenseBitmap frontier_bitmap;
+        graph_util::DenseBitmap next_frontier_bitmap;
+        bool bottom_up = false;
+
+        // The number of outgoing edges of the frontier and of the vertices that are not visited yet.
+        std::uint64_t frontier_edges = out_adjacency.Degree(src_vertex_id);
+        std::uint64_t unexplored_edges = out_adjacency.EdgeCount() - frontier_edges;
+
+        for (std::uint64_t distance = 1;; ++distance) {
+            std::uint64_t frontier_size = bottom_up ? frontier_bitmap.Size() : frontier.size();
+            if (frontier_size == 0) {
+                return false;
+            }
+
+            if (!bottom_up && frontier_edges * kTopDownRatio > unexplored_edges) {
+                if (!bitmaps_allocated) {
+                    visited = graph_util::DenseBitmap(vertex_count);
+                    for (const std::uint64_t vertex: discovered) {
+                        visited.Insert(vertex);
+                    }
+                    graph_util::VertexVector().swap(discovered);
+                    frontier_bitmap = graph_util::DenseBitmap(vertex_count);
+                    next_frontier_bitmap = graph_util::DenseBitmap(vertex_count);
+                    bitmaps_allocated = true;
+                }
+                frontier_bitmap.Clear();
+                for (const std::uint64_t vertex: frontier) {
+                    frontier_bitmap.Insert(vertex);
+                }
+                bottom_up = true;
+            } else if (bottom_up && frontier_size * kBottomUpRatio < vertex_count) {
+                frontier.clear();
+                frontier_bitmap.ForEach([&frontier](const std::uint64_t vertex) { frontier.push_back(vertex); });
+                bottom_up = false;
+            }
+
+            frontier_edges = 0;
+            bool reached_dst_vertex = false;
+            const auto visit = [&](const std::uint64_t vertex, const std::uint64_t parent) {
+                state.SetDistance(vertex, distance);
+                state.SetParent(vertex, parent);
+                if (bitmaps_allocated) {
+                    visited.Insert(vertex);
+                } else {
+                    discovered.push_back(vertex);
+                }
+                recorder.VertexTouched();
+                recorder.LevelReached(distance);
+
+                const std::uint64_t degree = out_adjacency.Degree(vertex);
+                frontier_edges += degree;
+                unexplored_edges -= degree;
+                reached_dst_vertex = reached_dst_vertex || vertex == dst_vertex_id;
+            };
+
+            if (bottom_up) {
+                next_frontier_bitmap.Clear();
+                for (std::uint64_t vertex = 0; vertex < vertex_count && !reached_dst_vertex; ++vertex) {
+                    if (visited.Contains(vertex)) {
+                        continue;
+                    }
+                    if (!valid_vertices.Contains(vertex)) {
+                        recorder.LabelRejected();
+                        continue;
+                    }
+                    recorder.VertexDequeued();
+
+                    in_adjacency.ForEachNeighbour(vertex, [&](const std::uint64_t parent) {
+                        recorder.EdgeScanned();
+                        if (!frontier_bitmap.Contains(parent)) {
+                            return true;
+                        }
+                        visit(vertex, parent);
+                        next_frontier_bitmap.Insert(vertex);
+                        return false;
+                    });
+                }
+                std::swap(frontier_bitmap, next_frontier_bitmap);
+            } else {
+                next_frontier.clear();
+                for (std::uint64_t i = 0; i < frontier.size() && !reached_dst_vertex; ++i) {
+                    const std::uint64_t curr_vertex = frontier[i];
+                    recorder.VertexDequeued();
+                    out_adjacency.ForEachNeighbour(curr_vertex, [&](const std::uint64_t neighbour) {
+                        recorder.EdgeScanned();
+                        if (!valid_vertices.Contains(neighbour)) {
+                            recorder.LabelRejected();
+                            return true;
+                        }
+                        if (bitmaps_allocated ? visited.Contains(neighbour)
+                                              : state.GetDistance(neighbour) != unreachable) {
+                            return true;
+                        }
+                        visit(neighbour, curr_vertex);
+                        next_frontier.push_back(neighbour);
+                        return !reached_dst_vertex;
+                    });
+                }
+                frontier.swap(next_frontier);
+            }
+
+            if (reached_dst_vertex) {
+                return true;
+            }
+        }
+    }
+
+    template<typename Adjacency, typename LabelFilter, typename Recorder>
+    std::optional<graph_util::Path>
+    GraphStore::parallelSearch(const Adjacency &adjacency, SearchState &search_state,
+                               const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id,
+                               const LabelFilter &valid_vertices, Recorder &recorder) const {
+        constexpr graph_util::VertexId unvisited = graph_util::kNoVertex;
+
+        // The number of frontier vertices claimed by a thread at once. Small enough to balance the skewed degrees,
+        // large enough to keep the contention on the cursor low.
+        constexpr std::size_t kChunkSize = 64;
+
+        // Smaller levels and arrays are processed on the calling thread only, waking up the pool costs more than
+        // the work itself.
+        constexpr std::size_t kParallelThreshold = 4 * kChunkSize;
+
+        const std::size_t thread_count = thread_pool_->ThreadCount();
+
+        // parents[v] is the vertex from which v was discovered, the source is its own parent. The parents are reset
+        // between the queries, so only the vertices claimed by this query need to be reset before the return.
+        std::atomic<graph_util::VertexId> *const parents = search_state.parents.get();
+        parents[src_vertex_id].store(graph_util::VertexId(src_vertex_id), std::memory_order_relaxed);
+        recorder.VertexTouched();
+
+        // The claimed vertices in the order of their levels, the current frontier is [frontier_begin, claimed.size()).
+        graph_util::VertexVector claimed = {src_vertex_id};
+        std::size_t frontier_begin = 0;
+        std::uint64_t level = 0;
+        std::mutex recorder_mutex;
+        std::vector<graph_util::VertexVector> local_frontiers(thread_count);
+        std::vector<std::size_t> local_offsets(thread_count + 1);
+
+        while (frontier_begin < claimed.size() &&
+               parents[dst_vertex_id].load(std::memory_order_relaxed) == unvisited) {
+            const std::size_t frontier_end = claimed.size();
+            std::atomic<std::size_t> cursor{frontier_begin};
+            std::atomic<bool> reached_dst_vertex{false};
+            ++level;
+
+            const auto expand_frontier = [&](const std::size_t thread_index) {
+                auto &local_frontier = local_frontiers[thread_index];
+                local_frontier.clear();
+                Recorder local_recorder;
+
+                while (!reached_dst_vertex.load(std::memory_order_relaxed)) {
+                    const std::size_t begin = cursor.fetch_add(kChunkSize, std::memory_order_relaxed);
+                    if (begin >= frontier_end) {
+                        break;
+                    }
+
+                    const std::size_t end = std::min(begin + kChunkSize, frontier_end);
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const std::uint64_t curr_vertex = claimed[i];
+                        local_recorder.VertexDequeued();
+                        adjacency.ForEachNeighbour(curr_vertex, [&](const std::uint64_t neighbour) {
+                            local_recorder.EdgeScanned();
+                            if (!valid_vertices.Contains(neighbour)) {
+                                local_recorder.LabelRejected();
+                                return true;
+                            }
+
+                            // Check before the compare-and-swap, most neighbours are already visited.
+                            graph_util::VertexId expected = unvisited;
+                            if (parents[neighbour].load(std::memory_order_relaxed) != unvisited ||
+                                !parents[neighbour].compare_exchange_strong(
+                                        expected, graph_util::VertexId(curr_vertex), std::memory_order_relaxed)) {
+                                return true;
+                            }
+
+                            local_frontier.push_back(neighbour);
+                            local_recorder.VertexTouched();
+                            local_recorder.LevelReached(level);
+                            if (neighbour == dst_vertex_id) {
+                                reached_dst_vertex.store(true, std::memory_order_relaxed);
+                                return false;
+                            }
+                            return true;
+                        });
+                    }
+                }
+
+                if constexpr (Recorder::kEnabled) {
+                    std::lock_guard<std::mutex> lock(recorder_mutex);
+                    recorder.Merge(local_recorder);
+                }
+            };
+
+            // The next level is appended to the claimed vertices also when the destination was reached, so that the
+            // parents claimed by all threads are reset below.
+            if (frontier_end - frontier_begin < kParallelThreshold) {
+                expand_frontier(0);
+                claimed.insert(claimed.end(), local_frontiers[0].begin(), local_frontiers[0].end());
+            } else {
+                thread_pool_->Run(expand_frontier);
+
+                // Concatenate the local frontiers into the next level, every thread copies its own part.
+                local_offsets[0] = frontier_end;
+                for (std::size_t i = 0; i < thread_count; ++i) {
+                    local_offsets[i + 1] = local_offsets[i] + local_frontiers[i].size();
                 }
+                claimed.resize(local_offsets[thread_count]);
+                thread_pool_->Run([&](const std::size_t thread_index) {
+                    const auto &local_frontier = local_frontiers[thread_index];
+                    std::copy(local_frontier.begin(), local_frontier.end(),
+                              claimed.begin() + std::int64_t(local_offsets[thread_index]));
+                });
             }
+            frontier_begin = frontier_end;
         }
+        recorder.Lap(graph_util::QueryPhase::SEARCH);
 
-        if (!reached_dst_vertex) {
-            return resetVertexStateAndReturn(std::nullopt);
+        std::optional<graph_util::Path> path;
+        if (parents[dst_vertex_id].load(std::memory_order_relaxed) != unvisited) {
+            // Follow the parents from the destination back to the source.
+            path = graph_util::Path{0, {dst_vertex_id}};
+            for (std::uint64_t vertex = dst_vertex_id; vertex != src_vertex_id;) {
+                vertex = parents[vertex].load(std::memory_order_relaxed);
+                path->vertices.push_back(vertex);
+                ++path->length;
+            }
+            std::reverse(path->vertices.begin(), path->vertices.end());
+            recorder.Lap(graph_util::QueryPhase::PATH);
         }
 
-        auto path = vertex_state_->FindPath(src_vertex_id, dst_vertex_id);
-        vertex_state_->Reset();
+        const auto reset_parents = [&](const std::size_t thread_index) {
+            const std::size_t begin = claimed.size() * thread_index / thread_count;
+            const std::size_t end = claimed.size() * (thread_index + 1) / thread_count;
+            for (std::size_t i = begin; i < end; ++i) {
+                parents[claimed[i]].store(unvisited, std::memory_order_relaxed);
+            }
+        };
+        if (claimed.size() < kParallelThreshold) {
+            for (std::size_t i = 0; i < thread_count; ++i) {
+                reset_parents(i);
+            }
+        } else {
+            thread_pool_->Run(reset_parents);
+        }
+        recorder.Lap(graph_util::QueryPhase::RESET);
         return path;
     }
 
     bool GraphStore::vertexExists(const std::uint64_t vertex_id) const {
-        return vertex_id < graph_.neighbours.size();
+        return vertex_id < std::visit([](const auto &adjacency) { return adjacency.VertexCount(); },
+                                      graph_->neighbours);
     }
 
-    std::optional<graph_util::Path> GraphStore::resetVertexStateAndReturn(const std::optional<graph_util::Path> &path) {
-        vertex_state_->Reset();
-        return path;
+    std::unique_ptr<GraphStore::SearchState> GraphStore::acquireSearchState() const {
+        std::unique_ptr<SearchState> search_state;
+        {
+            std::lock_guard<std::mutex> lock(search_states_->mutex);
+            if (!search_states_->states.empty()) {
+                search_state = std::move(search_states_->states.back());
+                search_states_->states.pop_back();
+            }
+        }
+
+        if (search_state == nullptr) {
+            search_state = std::make_unique<SearchState>(createVertexState(options_.strategy));
+            if (options_.search == SearchAlgorithm::BIDIRECTIONAL_BFS) {
+                search_state->backward = createVertexState(options_.strategy);
+            }
+        }
+
+        // Grow the states by the vertices created since the state was used last time. The pool is shared with the
+        // snapshots, a state sized for a later version also fits the earlier ones.
+        const std::uint64_t vertex_count = std::visit([](const auto &adjacency) { return adjacency.VertexCount(); },
+                                                      graph_->neighbours);
+        const auto grow = [&search_state, vertex_count](auto &state) {
+            if (vertex_count > search_state->vertex_count) {
+                state.ProcessVertexAdditions(vertex_count - search_state->vertex_count);
+            }
+        };
+        if (options_.search == SearchAlgorithm::PARALLEL_BFS) {
+            // The released parents are all unvisited, so a larger array is allocated without copying them.
+            if (vertex_count > search_state->parents_capacity) {
+                const std::uint64_t capacity = std::max(vertex_count, 2 * search_state->parents_capacity);
+                search_state->parents.reset(new std::atomic<graph_util::VertexId>[capacity]);
+                for (std::uint64_t v = 0; v < capacity; ++v) {
+                    search_state->parents[v].store(graph_util::kNoVertex, std::memory_order_relaxed);
+                }
+                search_state->parents_capacity = capacity;
+            }
+        } else {
+            std::visit(grow, search_state->forward);
+        }
+        if (search_state->backward.has_value()) {
+            std::visit(grow, *search_state->backward);
+        }
+        search_state->vertex_count = std::max(search_state->vertex_count, vertex_count);
+
+        return search_state;
+    }
+
+    void GraphStore::releaseSearchState(std::unique_ptr<SearchState> search_state) const {
+        std::visit([](auto &state) { state.Reset(); }, search_state->forward);
+        if (search_state->backward.has_value()) {
+            std::visit([](auto &state) { state.Reset(); }, *search_state->backward);
+        }
+
+        std::lock_guard<std::mutex> lock(search_states_->mutex);
+        search_states_->states.push_back(std::move(search_state));
+    }
+
+    graph_util::LabelledGraph &GraphStore::mutableGraph() {
+        // A snapshot shares the current version, copy it so that the snapshot does not observe the modification.
+        if (graph_.use_count() > 1) {
+            graph_ = std::make_shared<graph_util::LabelledGraph>(*graph_);
+        }
+        return *graph_;
+    }
+
+    void GraphStore::openLog(const std::uint64_t snapshot_sequence_number) {
+        // Apply the records that are not reflected in the snapshot. The log is not open yet, so the replayed
+        // modifications are not logged again.
+        const auto recovery = graph_util::WriteAheadLog::Replay(
+                options_.wal_path, [this, snapshot_sequence_number](const graph_util::WriteAheadLog::Record &record) {
+                    if (record.sequence_number > snapshot_sequence_number) {
+                        applyLogRecord(record);
+                    }
+                });
+
+        wal_ = std::make_unique<graph_util::WriteAheadLog>(
+                options_.wal_path, recovery, std::max(recovery.last_sequence_number, snapshot_sequence_number),
+                options_.wal_flush_interval, options_.wal_sync);
+    }
+
+    void GraphStore::applyLogRecord(const graph_util::WriteAheadLog::Record &record) {
+        using RecordType = graph_util::WriteAheadLog::RecordType;
+
+        // With CONCURRENT layout a vertex is visible before its record is appended, so the vertices may be logged out
+        // of the order of their IDs and after the edges created on them. Every vertex up to the logged one is created.
+        const auto create_vertices_through = [this](const std::uint64_t vertex_id) {
+            while (!vertexExists(vertex_id)) {
+                createVertex();
+            }
+        };
+
+        bool applied = true;
+        switch (record.type) {
+            case RecordType::CREATE_VERTEX:
+                create_vertices_through(record.vertex_id);
+                break;
+            case RecordType::CREATE_EDGE:
+                create_vertices_through(std::max(record.vertex_id, record.argument));
+                applied = createEdge(record.vertex_id, record.argument);
+                break;
+            case RecordType::INTERN_LABEL:
+                InternLabel(record.label);
+                break;
+            case RecordType::ADD_LABEL:
+                applied = addLabel(record.vertex_id, graph_util::LabelId(record.argument));
+                break;
+            case RecordType::REMOVE_LABEL:
+                applied = removeLabel(record.vertex_id, graph_util::LabelId(record.argument));
+                break;
+            default:
+                applied = false;
+        }
+
+        if (!applied) {
+            throw std::runtime_error("The write-ahead log record " + std::to_string(record.sequence_number) +
+                                     " does not apply to the graph.");
+        }
+    }
+
+    void GraphStore::logModification(const graph_util::WriteAheadLog::RecordType type, const std::uint64_t vertex_id,
+                                     const std::uint64_t argument, const graph_util::Label &label) {
+        if (wal_ != nullptr) {
+            wal_->Append(type, vertex_id, argument, label);
+        }
+    }
+
+    std::shared_lock<std::shared_mutex> GraphStore::lockForConcurrentInsertion() {
+        while (true) {
+            std::shared_lock<std::shared_mutex> lock(version_mutex_);
+            // A snapshot can not be taken while the lock is held, so the version stays owned once this check passes.
+            if (graph_.use_count() == 1) {
+                return lock;
+            }
+            lock.unlock();
+
+            std::lock_guard<std::shared_mutex> exclusive_lock(version_mutex_);
+            mutableGraph();
+        }
+    }
+
+    std::uint64_t GraphStore::addVertex(graph_util::LabelledGraph &graph) {
+        const std::uint64_t id = std::visit([](auto &adjacency) { return adjacency.AddVertex(); }, graph.neighbours);
+        if (graph.in_neighbours.has_value()) {
+            // With CONCURRENT layout the concurrent calls may append to the two adjacencies in different orders, the
+            // in-edges adjacency allocates its records by the edges, so only the final vertex count has to match.
+            std::visit([](auto &adjacency) { adjacency.AddVertex(); }, *graph.in_neighbours);
+        }
+        if (graph.label_masks.has_value()) {
+            graph.label_masks->push_back(0);
+        }
+        return id;
+    }
+
+    void GraphStore::addEdge(graph_util::LabelledGraph &graph, const std::uint64_t src_vertex_id,
+                             const std::uint64_t dst_vertex_id) {
+        std::visit([src_vertex_id, dst_vertex_id](auto &adjacency) {
+            adjacency.AddEdge(src_vertex_id, dst_vertex_id);
+        }, graph.neighbours);
+        if (graph.in_neighbours.has_value()) {
+            std::visit([src_vertex_id, dst_vertex_id](auto &adjacency) {
+                adjacency.AddEdge(dst_vertex_id, src_vertex_id);
+            }, *graph.in_neighbours);
+        }
+    }
+
+    graph_util::VertexStateVariant GraphStore::createVertexState(const Strategy strategy) {
+        if (strategy == Strategy::OPTIMIZED_MEMORY) {
+            return graph_util::OptimizedMemoryVertexState();
+        }
+        if (strategy == Strategy::OPTIMIZED_RESET) {
+            return graph_util::EpochVertexState();
+        }
+        return graph_util::OptimizedPerformanceVertexState();
+    }
+
+    graph_util::Adjacency GraphStore::createAdjacency(const std::uint64_t vertex_count,
+                                                      const std::vector<graph_util::Edge> &edges,
+                                                      const bool transpose,
+                                                      graph_util::ThreadPool *const thread_pool) const {
+        if (options_.layout == AdjacencyLayout::CSR) {
+            return graph_util::CsrAdjacency::FromEdges(vertex_count, edges, transpose, thread_pool);
+        }
+        if (options_.layout == AdjacencyLayout::DELTA_CSR) {
+            return graph_util::DeltaCsrAdjacency(
+                    graph_util::CsrAdjacency::FromEdges(vertex_count, edges, transpose, thread_pool),
+                    options_.delta_merge_threshold);
+        }
+        if (options_.layout == AdjacencyLayout::COMPRESSED_CSR) {
+            return graph_util::CompressedCsrAdjacency::FromCsr(
+                    graph_util::CsrAdjacency::FromEdges(vertex_count, edges, transpose, thread_pool), thread_pool);
+        }
+
+        const auto populate = [&](auto adjacency) -> graph_util::Adjacency {
+            for (std::uint64_t v = 0; v < vertex_count; ++v) {
+                adjacency.AddVertex();
+            }
+            for (const auto &edge: edges) {
+                if (transpose) {
+                    adjacency.AddEdge(edge.destination_vertex, edge.source_vertex);
+                } else {
+                    adjacency.AddEdge(edge.source_vertex, edge.destination_vertex);
+                }
+            }
+            return adjacency;
+        };
+        if (options_.layout == AdjacencyLayout::CONCURRENT) {
+            return populate(graph_util::ConcurrentAdjacency());
+        }
+        return populate(graph_util::AdjacencyList());
+    }
+
+    graph_util::Adjacency GraphStore::adjacencyFromCsr(graph_util::CsrAdjacency csr,
+                                                       graph_util::ThreadPool *const thread_pool) const {
+        if (options_.layout == AdjacencyLayout::CSR) {
+            return csr;
+        }
+        if (options_.layout == AdjacencyLayout::DELTA_CSR) {
+            return graph_util::DeltaCsrAdjacency(std::move(csr), options_.delta_merge_threshold);
+        }
+        if (options_.layout == AdjacencyLayout::COMPRESSED_CSR) {
+            return graph_util::CompressedCsrAdjacency::FromCsr(csr, thread_pool);
+        }
+
+        const auto populate = [&csr](auto adjacency) -> graph_util::Adjacency {
+            for (std::uint64_t v = 0; v < csr.VertexCount(); ++v) {
+                adjacency.AddVertex();
+            }
+            for (std::uint64_t v = 0; v < csr.VertexCount(); ++v) {
+                csr.ForEachNeighbour(v, [&adjacency, v](const std::uint64_t neighbour) {
+                    adjacency.AddEdge(v, neighbour);
+                    return true;
+                });
+            }
+            return adjacency;
+        };
+        if (options_.layout == AdjacencyLayout::CONCURRENT) {
+            return populate(graph_util::ConcurrentAdjacency());
+        }
+        return populate(graph_util::AdjacencyList());
     }
 
 } // namespace graph_store
\ No newline at end of file
@@ -2,13 +2,23 @@
 #define GRAPHSTORE_GRAPH_STORE_HPP
 
 #include "util/graph_util.hpp"
+#include "util/labelled_graph.hpp"
+#include "util/metrics.hpp"
+#include "util/query_stats.hpp"
 #include "util/vertex_state.hpp"
+#include "util/thread_pool.hpp"
+#include "util/write_ahead_log.hpp"
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
 #include <cstdint>
 #include <string>
 #include <optional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 
 namespace graph_store {
@@ -27,7 +37,77 @@ namespace graph_store {
         /// Enum for the different optimization options for storing and handling vertex data in Graph Store
         enum class Strategy {
             OPTIMIZED_PERFORMANCE,
-            OPTIMIZED_MEMORY
+            OPTIMIZED_MEMORY,
+            /// O(V) vectors like OPTIMIZED_PERFORMANCE, but the state is reset in O(1) time after every query
+            OPTIMIZED_RESET
+        };
+
+        /// Enum for the different layouts of the adjacency data in Graph Store
+        enum class AdjacencyLayout {
+            /// Separate vector per vertex, cheap edge insertion.
+            ADJACENCY_LIST,
+            /// Compressed Sparse Row, contiguous traversal but O(V+E) edge insertion.
+            CSR,
+            /// Compressed Sparse Row with per-vertex delta buffers merged in the background, amortized O(1) edge
+            /// insertion and mostly contiguous traversal.
+            DELTA_CSR,
+            /// Segmented vertex table with per-vertex chunked edge blocks, CreateVertex and CreateEdge may be called
+            /// from many threads at once and append without locks. Does not support label masks and Snapshot.
+            CONCURRENT,
+            /// Compressed Sparse Row with the sorted neighbours gap-encoded in Group Varint format, a fraction of the
+            /// memory of CSR for decoding on every traversal, O(V+E) edge insertion.
+            COMPRESSED_CSR
+        };
+
+        /// Enum for the different algorithms of the shortest path search
+        enum class SearchAlgorithm {
+            /// Breadth First Search from the source vertex.
+            BFS,
+            /// Breadth First Search from both ends that expands the smaller frontier, requires in-edges.
+            BIDIRECTIONAL_BFS,
+            /// Breadth First Search that switches to bottom-up steps for large frontiers, requires in-edges.
+            DIRECTION_OPTIMIZING_BFS,
+            /// Level-synchronous Breadth First Search that expands every level on all threads of the thread pool.
+            PARALLEL_BFS
+        };
+
+        /// Options for configuring the Graph Store at construction
+        struct Options {
+            /// The optimization strategy for the vertex data
+            Strategy strategy = Strategy::OPTIMIZED_PERFORMANCE;
+            /// The layout of the adjacency data
+            AdjacencyLayout layout = AdjacencyLayout::ADJACENCY_LIST;
+            /// The minimal number of buffered edges that triggers a background merge, used by DELTA_CSR layout
+            std::uint64_t delta_merge_threshold = graph_util::DeltaCsrAdjacency::kDefaultMergeThreshold;
+            /// Store the first 64 interned labels as a bitmask per vertex instead of the per-label bitmaps. The label
+            /// test then reads one word of the vertex, which pays off for small label vocabularies.
+            bool label_masks = false;
+            /// Store the incoming edges of every vertex in addition to the outgoing ones, doubles the adjacency memory
+            bool store_in_edges = false;
+            /// The algorithm used by ShortestPath
+            SearchAlgorithm search = SearchAlgorithm::BFS;
+            /// The number of threads used by PARALLEL_BFS and by the bulk load of CSR based layouts, 0 means one
+            /// thread per hardware thread
+            std::size_t thread_count = 0;
+            /// The path of the write-ahead log, empty disables the logging. The log is replayed by the constructor and
+            /// by OpenSnapshot, the modifications are appended to it.
+            std::string wal_path;
+            /// The longest time between a modification and the write of its log record
+            std::chrono::milliseconds wal_flush_interval{10};
+            /// Sync the log to the storage after every write, otherwise a crash of the OS may lose the written records
+            bool wal_sync = true;
+            /// Record the count and the latency of every operation for Metrics, costs two clock reads per operation
+            bool metrics = true;
+        };
+
+        /// One shortest path query of ShortestPathBatch
+        struct Query {
+            /// Start vertex of the path
+            std::uint64_t src_vertex_id;
+            /// Destination vertex of the path
+            std::uint64_t dst_vertex_id;
+            /// The label that should be set to each vertex on the shortest path
+            graph_util::Label label;
         };
 
         /// Creates the object with default strategy
@@ -36,6 +116,13 @@ namespace graph_store {
         /// Creates the object with passed strategy
         explicit GraphStore(Strategy strategy);
 
+        /// @brief Creates the object with passed options. If options.wal_path is set, the modifications recorded in the
+        /// write-ahead log are replayed, and the later modifications are appended to it.
+        /// @throws std::invalid_argument if the search algorithm requires in-edges and they are not stored, or if the
+        /// label masks are requested with CONCURRENT layout
+        /// @throws std::runtime_error if the write-ahead log can not be opened or does not apply
+        explicit GraphStore(const Options &options);
+
         /// Destructs the object
         ~GraphStore();
 
@@ -51,14 +138,34 @@ namespace graph_store {
                    Strategy strategy = Strategy::OPTIMIZED_MEMORY
         );
 
-        /// @brief Creates a new vertex in the Graph Store
-        ///const
+        /// @brief Creates the Graph Store and populates passed labels and edges into it.
+        /// The adjacencies are built at once instead of one insertion per vertex and edge, with CSR based layouts by a
+        /// parallel counting sort on options.thread_count threads.
+        ///
+        /// @param vertex_count The number of vertices in the graph
+        /// @param label_to_vertices The hash map from a label to the hash set of vertices that have this label set
+        /// @param edges The vector of directed edges to be populated in Graph Store
+        /// @param options The options of the Graph Store
+        /// @throws std::invalid_argument if the options are not valid, if vertex_count exceeds
+        /// graph_util::kMaxVertexCount, or if the write-ahead log is set: the bulk load is not logged, save a snapshot
+        /// of the loaded store and open it with the log instead
+        GraphStore(std::uint64_t vertex_count,
+                   const std::unordered_map<graph_util::Label, graph_util::VertexSet> &label_to_vertices,
+                   const std::vector<graph_util::Edge> &edges,
+                   const Options &options
+        );
+
+        /// @brief Creates a new vertex in the Graph Store. With CONCURRENT layout the method may be called from many
+        /// threads at once, concurrently with CreateEdge and the label modifications.
+        ///
         /// @return Unique ID of the created vertex
+        /// @throws std::length_error if the Graph Store already holds graph_util::kMaxVertexCount vertices
         ///
         std::uint64_t CreateVertex();
 
 
-        /// @brief Creates a directed edge between passed vertices
+        /// @brief Creates a directed edge between passed vertices. With CONCURRENT layout the method may be called from
+        /// many threads at once, concurrently with CreateVertex and the label modifications.
         ///
         /// @param src_vertex_id The origin vertex ID of the edge
         /// @param dst_vertex_id The destination vertex ID of the edge
@@ -75,6 +182,15 @@ namespace graph_store {
         ///
         bool AddLabel(std::uint64_t vertex_id, const graph_util::Label &label);
 
+        /// @brief Adds the label with the pre-resolved ID to the passed vertex, the method has no effect if the label
+        /// is already set for the vertex.
+        ///
+        /// @param vertex_id The ID of the vertex to process
+        /// @param label_id The ID of the label to be added to the vertex, returned by InternLabel
+        /// @return false in case if the vertex or the label ID is not found, otherwise return true.
+        ///
+        bool AddLabel(std::uint64_t vertex_id, graph_util::LabelId label_id);
+
         ///
         /// @brief Removes the label source_vertex the passed vertex, method has no effect if the vertex does not contain the
         /// passed label
@@ -85,6 +201,25 @@ namespace graph_store {
         ///
         bool RemoveLabel(std::uint64_t vertex_id, const graph_util::Label &label);
 
+        ///
+        /// @brief Removes the label with the pre-resolved ID from the passed vertex, method has no effect if the vertex
+        /// does not contain the label
+        ///
+        /// @param vertex_id The ID of the vertex to process
+        /// @param label_id The ID of the label to be removed from the vertex, returned by InternLabel
+        /// @return false in case when vertex is not found, otherwise return true.
+        ///
+        bool RemoveLabel(std::uint64_t vertex_id, graph_util::LabelId label_id);
+
+        ///
+        /// @brief Resolves the label to its dense ID, so that the label string is hashed only once instead of on
+        /// every AddLabel, RemoveLabel and ShortestPath call. Interning a label does not set it to any vertex.
+        ///
+        /// @param label The label to resolve
+        /// @return The ID of the label, the same label always gets the same ID within one Graph Store
+        ///
+        graph_util::LabelId InternLabel(const graph_util::Label &label);
+
         ///
         /// @brief Finds the shortest directed path between 2 vertices such that each vertex on the path contains the
         /// given label.
@@ -96,18 +231,371 @@ namespace graph_store {
         ///     - E is the  Number of edges in the graph.
         ///     - |L| is The length of the label.
         ///
+        /// The method is reentrant: every call searches with its own scratch state taken from a pool, so any number of
+        /// threads can call it concurrently as long as the graph is not modified at the same time.
+        ///
+        /// @param src_vertex_id Start vertex of the path
+        /// @param dst_vertex_id Destination vertex of the path
+        /// @param label The label that should be set to each vertex on the shortest path
+        /// @return graph_util::Path If valid path was found
+        /// @return std::nullopt If path was not found, or passed vertices does not exist
+        ///
+        std::optional<graph_util::Path>
+        ShortestPath(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id, const graph_util::Label &label) const;
+
+        ///
+        /// @brief Finds the shortest directed path between 2 vertices such that each vertex on the path contains the
+        /// label with the pre-resolved ID. Unlike the overload taking the label string, the label is not hashed.
+        ///
+        /// @param src_vertex_id Start vertex of the path
+        /// @param dst_vertex_id Destination vertex of the path
+        /// @param label_id The ID of the label that should be set to each vertex on the shortest path
+        /// @return graph_util::Path If valid path was found
+        /// @return std::nullopt If path was not found, or passed vertices or label ID does not exist
+        ///
+        std::optional<graph_util::Path>
+        ShortestPath(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id, graph_util::LabelId label_id) const;
+
+        ///
+        /// @brief Finds the shortest path like ShortestPath and reports the execution statistics of the query: the
+        /// scanned vertices and edges, the label filter rejections, the depth of the search, the number of vertices
+        /// stored in the vertex states and the time of the search, the path reconstruction and the state reset.
+        ///
+        /// The queries without statistics run a separate instantiation of the search, so they do not pay for it.
+        ///
         /// @param src_vertex_id Start vertex of the path
         /// @param dst_vertex_id Destination vertex of the path
         /// @param label The label that should be set to each vertex on the shortest path
+        /// @param stats Receives the statistics of the query, all fields are overwritten
         /// @return graph_util::Path If valid path was found
         /// @return std::nullopt If path was not found, or passed vertices does not exist
         ///
         std::optional<graph_util::Path>
-        ShortestPath(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id, const graph_util::Label &label);
+        ShortestPath(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id, const graph_util::Label &label,
+                     graph_util::QueryStats &stats) const;
+
+        ///
+        /// @brief Finds the shortest path like ShortestPath with the pre-resolved label ID and reports the execution
+        /// statistics of the query.
+        ///
+        /// @param src_vertex_id Start vertex of the path
+        /// @param dst_vertex_id Destination vertex of the path
+        /// @param label_id The ID of the label that should be set to each vertex on the shortest path
+        /// @param stats Receives the statistics of the query, all fields are overwritten
+        /// @return graph_util::Path If valid path was found
+        /// @return std::nullopt If path was not found, or passed vertices or label ID does not exist
+        ///
+        std::optional<graph_util::Path>
+        ShortestPath(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id, graph_util::LabelId label_id,
+                     graph_util::QueryStats &stats) const;
+
+        ///
+        /// @brief Answers many shortest path queries at once. The queries are grouped by label, and the queries of one
+        /// group are answered by bit-parallel multi-source Breadth First Search: up to 64 searches share one sweep over
+        /// the graph, every vertex keeps one bit per search in a 64-bit word, and one neighbour scan advances all
+        /// searches that reached the vertex. The sweep of a group stops once all its destinations are reached.
+        ///
+        /// The result does not depend on the search algorithm in the options. For each query some shortest path is
+        /// returned, which may differ from the one returned by ShortestPath if there are several.
+        ///
+        /// @param queries The queries to answer
+        /// @return The i-th element is the answer to the i-th query, as it would be returned by ShortestPath
+        ///
+        std::vector<std::optional<graph_util::Path>> ShortestPathBatch(const std::vector<Query> &queries) const;
+
+        ///
+        /// @brief Takes an immutable snapshot of the current version of the graph. The snapshot is a read-only Graph
+        /// Store that can be queried from any number of threads, while the writer keeps modifying this Graph Store:
+        /// the queries on the snapshot never block and never observe the later modifications.
+        ///
+        /// Taking a snapshot takes O(1) time. The first modification after a snapshot copies the graph for the writer,
+        /// but the adjacencies share their storage with the snapshot: ADJACENCY_LIST and DELTA_CSR layouts copy the
+        /// pointers to their chunks of 1024 vertices and then the modified chunk only, DELTA_CSR shares its CSR bases
+        /// as well, and CSR and COMPRESSED_CSR layouts write the modified arrays into new ones within their O(V+E)
+        /// edge insertion. The label index is copied, which takes O(V / 64) time per label. The snapshot may be taken
+        /// concurrently with the modifications, it then waits for the running modification only.
+        ///
+        /// @return The snapshot, the snapshot stays valid after this Graph Store is destroyed
+        /// @throws std::logic_error with CONCURRENT layout, its lock-free adjacency can not be shared and would be
+        /// copied whole by the next modification
+        ///
+        std::shared_ptr<const GraphStore> Snapshot() const;
+
+        ///
+        /// @brief Takes a snapshot of the metrics: the count and the latency histogram of every CreateVertex,
+        /// CreateEdge, AddLabel, RemoveLabel, ShortestPath and ShortestPathBatch call, the numbers of vertices, edges
+        /// and labels, and the memory breakdown of MemoryUsage. A batch is timed as one call, its queries are not
+        /// counted as ShortestPath calls. The operations of the bulk load and of the log replay are not counted. The
+        /// snapshots taken by Snapshot share the operation metrics with this Graph Store.
+        ///
+        /// The operations are recorded into per-thread shards without locks. The gauges are computed under the lock
+        /// of the modifications, see MemoryUsage for the time it takes.
+        ///
+        /// @return The metrics, the operation metrics stay zero if options.metrics is not set. Format them with
+        /// graph_util::ToPrometheusText to serve them to Prometheus.
+        ///
+        graph_util::StoreMetrics Metrics() const;
+
+        ///
+        /// @brief Measures the heap memory of the current version of the graph and of the idle search states: the
+        /// bytes of the adjacencies, of the label index and of the vertex states, and the unused capacity of all of
+        /// them as slack. The vectors are measured by their capacity, the hash maps of the label dictionary and of
+        /// OPTIMIZED_MEMORY states count their allocations with graph_util::CountingAllocator. The allocator overhead,
+        /// the graph versions held only by the snapshots and the states of the running queries are not counted.
+        ///
+        /// The memory is measured under the lock of the modifications, in O(V) time with ADJACENCY_LIST, DELTA_CSR and
+        /// CONCURRENT layouts and O(1) time with CSR and COMPRESSED_CSR layouts, plus the time of the label index.
+        ///
+        /// @return The memory breakdown
+        ///
+        graph_util::MemoryUsage MemoryUsage() const;
+
+        ///
+        /// @brief Waits until the log records of all the modifications completed before the call are written and, if
+        /// options.wal_sync is set, synced to the storage. The modifications themselves do not wait for the log, they
+        /// are written in groups by a background thread once per options.wal_flush_interval.
+        ///
+        /// The method has no effect if the write-ahead log is not set.
+        /// @throws std::runtime_error if writing the log failed
+        ///
+        void SyncLog();
+
+        ///
+        /// @brief Saves the current version of the graph to a binary snapshot file: the CSR arrays of the outgoing
+        /// and, if stored, the incoming edges, the label dictionary and the vertices of every label. The file is
+        /// written under a temporary name and renamed when complete, so the processes that opened the previous file
+        /// at the path keep reading it intact.
+        ///
+        /// The snapshot records the sequence number of the last write-ahead log record it reflects, OpenSnapshot
+        /// replays only the later records.
+        ///
+        /// The modifications running concurrently wait until the version is taken, and then copy it instead of
+        /// modifying it while it's saved.
+        ///
+        /// @param path The path of the snapshot file, an existing file is replaced
+        /// @throws std::runtime_error if the file can not be written
+        ///
+        void SaveSnapshot(const std::string &path) const;
+
+        ///
+        /// @brief Opens the Graph Store from a snapshot file saved by SaveSnapshot. The file is memory-mapped, with
+        /// CSR and DELTA_CSR layouts the edges are read in place: opening takes the time of loading the labels only,
+        /// the pages of the edges are loaded on first access and shared with the other processes that opened the file.
+        /// The first modification of a CSR layout copies its arrays into memory. The other layouts copy the edges at
+        /// opening.
+        ///
+        /// @param path The path of the snapshot file
+        /// @param options The options of the opened Graph Store, the in-edges are built at opening if they are
+        /// requested but not stored in the file. If options.wal_path is set, the log records that are not reflected
+        /// in the snapshot are replayed, and the later modifications are appended to the log.
+        /// @return The opened Graph Store
+        /// @throws std::runtime_error if the file can not be read or is not a valid snapshot, or if the write-ahead log
+        /// can not be opened or does not apply
+        /// @throws std::invalid_argument if the options are not valid
+        ///
+        static std::unique_ptr<GraphStore> OpenSnapshot(const std::string &path, const Options &options);
+
+        ///
+        /// @brief Opens the Graph Store from a snapshot file with CSR layout and the default options otherwise.
+        ///
+        /// @param path The path of the snapshot file
+        /// @return The opened Graph Store
+        /// @throws std::runtime_error if the file can not be read or is not a valid snapshot
+        ///
+        static std::unique_ptr<GraphStore> OpenSnapshot(const std::string &path);
+
+        ///
+        /// @brief Loads the Graph Store from text files: an edge list with one "src dst" pair of vertex IDs per line,
+        /// and optionally a label file with one "label vertex" pair per line. The columns are separated by spaces or
+        /// tabs, the empty lines and the lines starting with '#' or '%' are skipped. The graph has as many vertices
+        /// as the largest vertex ID in the files plus one.
+        ///
+        /// The files are memory-mapped and parsed in chunks on options.thread_count threads. The edges are scattered
+        /// straight into the CSR arrays instead of being collected first, so the memory stays bounded by the size of
+        /// the loaded graph rather than the size of the text. The neighbours of every vertex are sorted by their IDs.
+        /// The labels get their IDs in the order of their first line.
+        ///
+        /// @param edge_list_path The path of the edge list
+        /// @param labels_path The path of the label file, empty if there are no labels
+        /// @param options The options of the loaded Graph Store
+        /// @return The loaded Graph Store
+        /// @throws std::runtime_error if a file can not be read or has a malformed line
+        /// @throws std::invalid_argument if the options are not valid, or if the write-ahead log is set: the load is
+        /// not logged, save a snapshot of the loaded store and open it with the log instead
+        ///
+        static std::unique_ptr<GraphStore> LoadEdgeList(const std::string &edge_list_path,
+                                                        const std::string &labels_path, const Options &options);
 
     private:
-        graph_util::LabelledGraph graph_;
-        graph_util::VertexState *vertex_state_;
+        /// The number of the searches sharing one sweep of ShortestPathBatch, one bit of a 64-bit word per search.
+        static constexpr std::size_t kBatchWidth = 64;
+
+        // The current version of the graph, shared with the snapshots taken since its last modification.
+        std::shared_ptr<graph_util::LabelledGraph> graph_;
+
+        // Guards graph_ pointer against Snapshot calls running concurrently with the modifications. The modifications
+        // hold it exclusively, except for CreateVertex and CreateEdge with CONCURRENT layout that hold it shared and
+        // synchronize on the adjacency itself.
+        mutable std::shared_mutex version_mutex_;
+
+        // The scratch state of one ShortestPath call. The states are held by value, so that the searches are
+        // compiled for the concrete implementation.
+        struct SearchState {
+            explicit SearchState(graph_util::VertexStateVariant forward) : forward(std::move(forward)) {
+            }
+
+            graph_util::VertexStateVariant forward;
+            // The state of the backward search, present only for SearchAlgorithm::BIDIRECTIONAL_BFS.
+            std::optional<graph_util::VertexStateVariant> backward;
+            // parents[v] is the vertex from which v was discovered by SearchAlgorithm::PARALLEL_BFS, kNoVertex
+            // between the searches. Present only for PARALLEL_BFS, which does not use the vertex states.
+            std::unique_ptr<std::atomic<graph_util::VertexId>[]> parents;
+            // The number of elements of parents.
+            std::uint64_t parents_capacity = 0;
+            // The number of vertices the states are sized for.
+            std::uint64_t vertex_count = 0;
+        };
+
+        // The per-vertex masks of multiSourceSearch, allocated once per ShortestPathBatch call. Every batch leaves
+        // them zeroed for the next one.
+        struct BatchMasks {
+            // seen[v] has the bit i set if the i-th search of the batch reached the vertex v.
+            std::vector<std::uint64_t> seen;
+            // frontier[v] has the bit i set if the vertex v is in the current frontier of the i-th search.
+            std::vector<std::uint64_t> frontier;
+            // The masks of the next frontier.
+            std::vector<std::uint64_t> next;
+        };
+
+        // The idle scratch states, one is taken by every ShortestPath call for its duration.
+        struct SearchStatePool {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<SearchState>> states;
+        };
+
+        // The worker threads, allocated only for SearchAlgorithm::PARALLEL_BFS and shared with the snapshots.
+        std::shared_ptr<graph_util::ThreadPool> thread_pool_;
+
+        // The scratch states shared with the snapshots.
+        std::shared_ptr<SearchStatePool> search_states_;
+
+        const Options options_;
+
+        // The write-ahead log, present only if options_.wal_path is set and never shared with the snapshots.
+        std::unique_ptr<graph_util::WriteAheadLog> wal_;
+
+        // The sequence number of the opened snapshot file, saved again by SaveSnapshot if there is no log.
+        std::uint64_t snapshot_sequence_number_ = 0;
+
+        // The operation metrics, present only if options_.metrics is set and shared with the snapshots.
+        std::shared_ptr<graph_util::MetricsRegistry> metrics_;
+
+        ///
+        /// @brief Creates the object with passed options.
+        /// @param open_log Replay and open the write-ahead log, if it's set in the options
+        ///
+        GraphStore(const Options &options, bool open_log);
+
+        ///
+        /// @brief Creates the snapshot sharing the graph version and the resources with the Graph Store.
+        ///
+        GraphStore(std::shared_ptr<graph_util::LabelledGraph> graph, const Options &options,
+                   std::shared_ptr<graph_util::ThreadPool> thread_pool, std::shared_ptr<SearchStatePool> search_states,
+                   std::shared_ptr<graph_util::MetricsRegistry> metrics);
+
+        ///
+        /// @brief Copies the current version if it's shared with a snapshot, version_mutex_ should be held.
+        /// @return The current version of the graph, owned only by this Graph Store
+        ///
+        graph_util::LabelledGraph &mutableGraph();
+
+        ///
+        /// @brief Locks version_mutex_ shared for CreateVertex and CreateEdge with CONCURRENT layout. The current
+        /// version is copied first if it's shared with a snapshot, which needs the exclusive lock.
+        /// @return The lock, the current version is owned only by this Graph Store while it's held
+        ///
+        std::shared_lock<std::shared_mutex> lockForConcurrentInsertion();
+
+        ///
+        /// @brief Replays the write-ahead log on top of the loaded graph and opens it for appending.
+        /// @param snapshot_sequence_number The sequence number of the last record reflected in the graph
+        ///
+        void openLog(std::uint64_t snapshot_sequence_number);
+
+        ///
+        /// @brief Applies the replayed log record.
+        /// @throws std::runtime_error if the record does not apply to the graph
+        ///
+        void applyLogRecord(const graph_util::WriteAheadLog::Record &record);
+
+        ///
+        /// @brief Appends the record of the modification to the write-ahead log if it's set, version_mutex_ should be
+        /// held, so that the snapshots reflect exactly the records before their sequence number.
+        ///
+        void logModification(graph_util::WriteAheadLog::RecordType type, std::uint64_t vertex_id,
+                             std::uint64_t argument = 0, const graph_util::Label &label = graph_util::Label());
+
+        ///
+        /// @brief CreateVertex without the metrics, used by the log replay.
+        ///
+        std::uint64_t createVertex();
+
+        ///
+        /// @brief CreateEdge without the metrics, used by the log replay.
+        ///
+        bool createEdge(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id);
+
+        ///
+        /// @brief AddLabel with the label ID without the metrics, used by the bulk load and the log replay.
+        ///
+        bool addLabel(std::uint64_t vertex_id, graph_util::LabelId label_id);
+
+        ///
+        /// @brief RemoveLabel with the label ID without the metrics, used by the log replay.
+        ///
+        bool removeLabel(std::uint64_t vertex_id, graph_util::LabelId label_id);
+
+        ///
+        /// @brief MemoryUsage without the lock, version_mutex_ should be held.
+        ///
+        graph_util::MemoryUsage memoryUsage() const;
+
+        ///
+        /// @brief Appends a vertex to the adjacencies and the label masks of the graph.
+        /// @return The ID of the appended vertex
+        ///
+        static std::uint64_t addVertex(graph_util::LabelledGraph &graph);
+
+        ///
+        /// @brief Appends the edge to the adjacencies of the graph, both vertices should exist.
+        ///
+        static void addEdge(graph_util::LabelledGraph &graph, std::uint64_t src_vertex_id,
+                            std::uint64_t dst_vertex_id);
+
+        ///
+        /// @param strategy The optimization strategy
+        /// @return The VertexState implementing the strategy
+        ///
+        static graph_util::VertexStateVariant createVertexState(Strategy strategy);
+
+        ///
+        /// @param vertex_count The number of vertices in the adjacency
+        /// @param edges The edges to populate, all endpoints should be less than vertex_count
+        /// @param transpose Populate the reversed edges, used for the incoming edges
+        /// @param thread_pool The threads to build CSR based layouts on, nullptr builds on the calling thread
+        /// @return The adjacency in the layout selected by the options
+        ///
+        graph_util::Adjacency createAdjacency(std::uint64_t vertex_count, const std::vector<graph_util::Edge> &edges,
+                                              bool transpose, graph_util::ThreadPool *thread_pool) const;
+
+        ///
+        /// @param csr The adjacency to convert
+        /// @param thread_pool The threads to compress on with COMPRESSED_CSR layout, nullptr compresses on the calling
+        /// thread
+        /// @return The adjacency in the layout selected by the options, CSR based layouts keep the arrays of csr
+        ///
+        graph_util::Adjacency adjacencyFromCsr(graph_util::CsrAdjacency csr,
+                                               graph_util::ThreadPool *thread_pool = nullptr) const;
 
         ///
         /// @param vertex_id The vertex ID to check
@@ -116,10 +604,144 @@ namespace graph_store {
         bool vertexExists(std::uint64_t vertex_id) const;
 
         ///
-        /// @param path to return
-        /// @return std::optional<graph_util::Path>
+        /// @brief Finds the shortest path with the search algorithm of the options, recording the statistics.
+        ///
+        /// @param src_vertex_id Start vertex of the path
+        /// @param dst_vertex_id Destination vertex of the path
+        /// @param label_id The ID of the label that should be set to each vertex on the shortest path
+        /// @param recorder graph_util::QueryStatsRecorder, or graph_util::NoQueryStatsRecorder to skip the statistics
+        /// @return graph_util::Path If valid path was found
+        /// @return std::nullopt If path was not found, or passed vertices or label ID does not exist
+        ///
+        template<typename Recorder>
+        std::optional<graph_util::Path>
+        shortestPath(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id, graph_util::LabelId label_id,
+                     Recorder &recorder) const;
+
+        ///
+        /// @brief Runs Breadth First Search from the source vertex over the vertices in valid_vertices, until the
+        /// destination vertex is reached.
+        ///
+        /// @param adjacency The adjacency layout to traverse
+        /// @param state The scratch state of the search
+        /// @param src_vertex_id Start vertex of the search
+        /// @param dst_vertex_id Destination vertex of the search
+        /// @param valid_vertices The filter of the vertices that are allowed on the path
+        /// @param recorder The recorder of the query statistics
+        /// @return true if the destination vertex was reached, returns false otherwise
+        ///
+        template<typename Adjacency, typename State, typename LabelFilter, typename Recorder>
+        bool breadthFirstSearch(const Adjacency &adjacency, State &state, std::uint64_t src_vertex_id,
+                                std::uint64_t dst_vertex_id, const LabelFilter &valid_vertices,
+                                Recorder &recorder) const;
+
+        ///
+        /// @brief Runs Breadth First Search from both the source and the destination vertex, each step expands one
+        /// whole level of the smaller frontier. Forward search follows the outgoing edges, backward search follows
+        /// the incoming edges.
+        ///
+        /// @param out_adjacency The outgoing edges
+        /// @param in_adjacency The incoming edges, stored in the same layout
+        /// @param forward_state The scratch state of the forward search
+        /// @param backward_state The scratch state of the backward search
+        /// @param src_vertex_id Start vertex of the search
+        /// @param dst_vertex_id Destination vertex of the search
+        /// @param valid_vertices The filter of the vertices that are allowed on the path
+        /// @param recorder The recorder of the query statistics
+        /// @return The vertex where the searches met on a shortest path if the destination is reachable
+        /// @return std::nullopt if the destination vertex is not reachable
+        ///
+        template<typename Adjacency, typename State, typename LabelFilter, typename Recorder>
+        std::optional<std::uint64_t>
+        bidirectionalSearch(const Adjacency &out_adjacency, const Adjacency &in_adjacency, State &forward_state,
+                            State &backward_state, std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id,
+                            const LabelFilter &valid_vertices, Recorder &recorder) const;
+
+        ///
+        /// @brief Runs direction-optimizing Breadth First Search from the source vertex until the destination vertex is
+        /// reached. Small frontiers are expanded top-down along the outgoing edges. Once the edges of the frontier
+        /// outnumber a fraction of the unexplored edges, the search switches to bottom-up steps, where every
+        /// unvisited labelled vertex scans its incoming edges for a parent in the frontier bitmap. The search switches
+        /// back once the frontier shrinks.
+        ///
+        /// @param out_adjacency The outgoing edges
+        /// @param in_adjacency The incoming edges, stored in the same layout
+        /// @param state The scratch state of the search
+        /// @param src_vertex_id Start vertex of the search
+        /// @param dst_vertex_id Destination vertex of the search
+        /// @param valid_vertices The filter of the vertices that are allowed on the path
+        /// @param recorder The recorder of the query statistics
+        /// @return true if the destination vertex was reached, returns false otherwise
+        ///
+        template<typename Adjacency, typename State, typename LabelFilter, typename Recorder>
+        bool directionOptimizingSearch(const Adjacency &out_adjacency, const Adjacency &in_adjacency, State &state,
+                                       std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id,
+                                       const LabelFilter &valid_vertices, Recorder &recorder) const;
+
+        ///
+        /// @brief Runs level-synchronous Breadth First Search on all threads of thread_pool_ until the level containing
+        /// the destination vertex is expanded. The threads claim chunks of the current frontier from a shared cursor,
+        /// claim the discovered vertices with compare-and-swap on the parent array and collect them in per-thread
+        /// frontiers, which are concatenated into the next level. The vertex states are not used, the parents of the
+        /// claimed vertices are reset before the return, so a query costs the vertices it visits, not the graph size.
+        ///
+        /// @param adjacency The adjacency layout to traverse
+        /// @param search_state The scratch state with the parent array sized for the graph
+        /// @param src_vertex_id Start vertex of the search
+        /// @param dst_vertex_id Destination vertex of the search
+        /// @param valid_vertices The filter of the vertices that are allowed on the path
+        /// @param recorder The recorder of the query statistics, the threads record into their own recorders that
+        /// are merged after every level
+        /// @return graph_util::Path If the destination vertex was reached
+        /// @return std::nullopt If the destination vertex is not reachable
+        ///
+        template<typename Adjacency, typename LabelFilter, typename Recorder>
+        std::optional<graph_util::Path>
+        parallelSearch(const Adjacency &adjacency, SearchState &search_state, std::uint64_t src_vertex_id,
+                       std::uint64_t dst_vertex_id, const LabelFilter &valid_vertices, Recorder &recorder) const;
+
+        ///
+        /// @brief Runs bit-parallel multi-source Breadth First Search for up to kBatchWidth queries with the same
+        /// label, the search of the i-th query in the batch owns the bit i of the per-vertex masks. Every discovery is
+        /// recorded per level together with its parent and the searches it advanced, the paths are then reconstructed
+        /// by one backward sweep over the recorded levels.
+        ///
+        /// @param adjacency The adjacency layout to traverse
+        /// @param queries All queries of the ShortestPathBatch call
+        /// @param batch The indices of the queries to answer, the endpoints should be valid and have the label set
+        /// @param valid_vertices The filter of the vertices that have the label of the batch set
+        /// @param masks The zeroed masks, grown to the vertex count if needed and zeroed again before the return by
+        /// clearing only the entries of the recorded discoveries
+        /// @param paths The answers, the paths of the reachable destinations are stored at the query indices
+        ///
+        template<typename Adjacency, typename LabelFilter>
+        void multiSourceSearch(const Adjacency &adjacency, const std::vector<Query> &queries,
+                               const std::vector<std::size_t> &batch, const LabelFilter &valid_vertices,
+                               BatchMasks &masks, std::vector<std::optional<graph_util::Path>> &paths) const;
+
+        ///
+        /// @brief Calls visitor with the concrete filter of the vertices that have the label set: the label mask
+        /// filter if the label is stored in the label masks, otherwise the bitmap of the label.
+        ///
+        /// @param label_id The label ID to process, should be valid
+        /// @param visitor Callable taking the filter, it should return the same type for every filter
+        /// @return The value returned by visitor
+        ///
+        template<typename Visitor>
+        decltype(auto) visitLabelFilter(graph_util::LabelId label_id, Visitor &&visitor) const;
+
+        ///
+        /// @brief Takes an idle scratch state from the pool or creates a new one, and sizes it for the current
+        /// vertices.
+        /// @return The scratch state owned by the caller until it's passed to releaseSearchState
+        ///
+        std::unique_ptr<SearchState> acquireSearchState() const;
+
+        ///
+        /// @brief Resets the scratch state and returns it to the pool.
+        /// @param search_state The scratch state returned by acquireSearchState
         ///
-        std::optional<graph_util::Path> resetVertexStateAndReturn(const std::optional<graph_util::Path> &path);
+        void releaseSearchState(std::unique_ptr<SearchState> search_state) const;
     };
 
 } // namespace graph_store
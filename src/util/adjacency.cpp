@@ -0,0 +1,795 @@
+#include "adjacency.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace graph_util {
+
+    namespace {
+
+        // Throws if one more vertex does not fit into the width of the stored vertex IDs.
+        void checkVertexCapacity(const std::uint64_t vertex_count) {
+            if (vertex_count >= kMaxVertexCount) {
+                throw std::length_error("The number of vertices exceeds the width of the vertex IDs.");
+            }
+        }
+
+        // Returns the buffer for modification, copies it first if it's shared with a copy of the adjacency.
+        template<typename T>
+        std::vector<T> &unshare(std::shared_ptr<std::vector<T>> &buffer) {
+            if (buffer.use_count() > 1) {
+                buffer = std::make_shared<std::vector<T>>(*buffer);
+            }
+            return *buffer;
+        }
+
+        // Replaces the elements [begin, end) of the buffer with the replacement. The buffer shared with a copy of the
+        // adjacency is not copied first, the result is written into a new buffer in the same pass instead.
+        template<typename T>
+        void splice(std::shared_ptr<std::vector<T>> &buffer, const std::uint64_t begin, const std::uint64_t end,
+                    const std::vector<T> &replacement) {
+            if (buffer.use_count() > 1) {
+                auto result = std::make_shared<std::vector<T>>();
+                result->reserve(buffer->size() - (end - begin) + replacement.size());
+                result->insert(result->end(), buffer->begin(), buffer->begin() + std::int64_t(begin));
+                result->insert(result->end(), replacement.begin(), replacement.end());
+                result->insert(result->end(), buffer->begin() + std::int64_t(end), buffer->end());
+                buffer = std::move(result);
+                return;
+            }
+            auto &elements = *buffer;
+            const auto position = elements.erase(elements.begin() + std::int64_t(begin),
+                                                 elements.begin() + std::int64_t(end));
+            elements.insert(position, replacement.begin(), replacement.end());
+        }
+
+    } // namespace
+
+    std::uint64_t AdjacencyList::VertexCount() const {
+        return neighbours_.Size();
+    }
+
+    std::uint64_t AdjacencyList::EdgeCount() const {
+        return edge_count_;
+    }
+
+    MemoryFootprint AdjacencyList::Footprint() const {
+        MemoryFootprint footprint = neighbours_.Footprint();
+        for (std::uint64_t v = 0; v < neighbours_.Size(); ++v) {
+            footprint.AddBuffer<VertexId>(neighbours_[v].size(), neighbours_[v].capacity());
+        }
+        return footprint;
+    }
+
+    std::uint64_t AdjacencyList::Degree(const std::uint64_t vertex_id) const {
+        return neighbours_[vertex_id].size();
+    }
+
+    std::uint64_t AdjacencyList::AddVertex() {
+        checkVertexCapacity(neighbours_.Size());
+        neighbours_.PushBack(VertexIdVector());
+        return neighbours_.Size() - 1;
+    }
+
+    void AdjacencyList::AddEdge(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id) {
+        neighbours_.Mutable(src_vertex_id).push_back(dst_vertex_id);
+        ++edge_count_;
+    }
+
+    CsrAdjacency::CsrAdjacency() : CsrAdjacency(std::vector<std::uint64_t>(1, 0), VertexIdVector()) {
+    }
+
+    CsrAdjacency::CsrAdjacency(std::vector<std::uint64_t> offsets, VertexIdVector targets) :
+            offsets_(std::make_shared<std::vector<std::uint64_t>>(std::move(offsets))),
+            targets_(std::make_shared<VertexIdVector>(std::move(targets))) {
+    }
+
+    CsrAdjacency::CsrAdjacency(std::shared_ptr<const void> storage, const std::uint64_t *const offsets,
+                               const std::uint64_t vertex_count, const VertexId *const targets) :
+            storage_(std::move(storage)), stored_offsets_(offsets), stored_targets_(targets),
+            stored_vertex_count_(vertex_count) {
+    }
+
+    CsrAdjacency CsrAdjacency::FromEdges(const std::uint64_t vertex_count, const std::vector<Edge> &edges,
+                                         const bool transpose, ThreadPool *const thread_pool) {
+        if (thread_pool != nullptr && thread_pool->ThreadCount() > 1 && edges.size() >= kParallelBuildThreshold) {
+            return fromEdgesParallel(vertex_count, edges, transpose, *thread_pool);
+        }
+
+        std::vector<std::uint64_t> offsets(vertex_count + 1, 0);
+        VertexIdVector targets(edges.size());
+
+        // Count the out-degrees, shifted by one so that the prefix sum yields the offsets.
+        for (const auto &edge: edges) {
+            ++offsets[(transpose ? edge.destination_vertex : edge.source_vertex) + 1];
+        }
+        for (std::uint64_t v = 0; v < vertex_count; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+
+        // Scatter the edges, positions[v] is the next free slot of the vertex v.
+        std::vector<std::uint64_t> positions(offsets.begin(), offsets.end() - 1);
+        for (const auto &edge: edges) {
+            if (transpose) {
+                targets[positions[edge.destination_vertex]++] = VertexId(edge.source_vertex);
+            } else {
+                targets[positions[edge.source_vertex]++] = VertexId(edge.destination_vertex);
+            }
+        }
+
+        return CsrAdjacency(std::move(offsets), std::move(targets));
+    }
+
+    CsrAdjacency CsrAdjacency::fromEdgesParallel(const std::uint64_t vertex_count, const std::vector<Edge> &edges,
+                                                 const bool transpose, ThreadPool &thread_pool) {
+        const std::size_t thread_count = thread_pool.ThreadCount();
+        const std::uint64_t edge_count = edges.size();
+
+        // The bucket b holds the origin vertices [b * bucket_width, (b + 1) * bucket_width).
+        const std::uint64_t bucket_width = std::max<std::uint64_t>(
+                1, (vertex_count + thread_count * kBucketsPerThread - 1) / (thread_count * kBucketsPerThread));
+        const std::uint64_t bucket_count = (vertex_count + bucket_width - 1) / bucket_width;
+
+        const auto origin = [transpose](const Edge &edge) {
+            return transpose ? edge.destination_vertex : edge.source_vertex;
+        };
+        const auto edge_range = [edge_count, thread_count](const std::size_t thread_index) {
+            return std::make_pair(edge_count * thread_index / thread_count,
+                                  edge_count * (thread_index + 1) / thread_count);
+        };
+
+        // Count the edges of every thread's range per bucket, cursors[t * bucket_count + b] for the thread t.
+        std::vector<std::uint64_t> cursors(thread_count * bucket_count, 0);
+        thread_pool.Run([&](const std::size_t thread_index) {
+            std::uint64_t *counts = cursors.data() + thread_index * bucket_count;
+            const auto [begin, end] = edge_range(thread_index);
+            for (std::uint64_t i = begin; i < end; ++i) {
+                ++counts[origin(edges[i]) / bucket_width];
+            }
+        });
+
+        // Turn the counts into the positions in the bucketed edges. The ranges of the threads follow each other
+        // within every bucket, so the bucketed edges keep the input order.
+        std::vector<std::uint64_t> bucket_offsets(bucket_count + 1);
+        std::uint64_t position = 0;
+        for (std::uint64_t b = 0; b < bucket_count; ++b) {
+            bucket_offsets[b] = position;
+            for (std::size_t t = 0; t < thread_count; ++t) {
+                const std::uint64_t count = cursors[t * bucket_count + b];
+                cursors[t * bucket_count + b] = position;
+                position += count;
+            }
+        }
+        bucket_offsets[bucket_count] = position;
+
+        // Default-initialized, every element is written by the scatter below.
+        std::unique_ptr<Edge[]> bucketed(new Edge[edge_count]);
+        thread_pool.Run([&](const std::size_t thread_index) {
+            std::uint64_t *positions = cursors.data() + thread_index * bucket_count;
+            const auto [begin, end] = edge_range(thread_index);
+            for (std::uint64_t i = begin; i < end; ++i) {
+                bucketed[positions[origin(edges[i]) / bucket_width]++] = edges[i];
+            }
+        });
+
+        std::vector<std::uint64_t> offsets(vertex_count + 1, 0);
+        VertexIdVector targets(edge_count);
+
+        // Every bucket owns the offsets of its vertices and a contiguous part of the targets, the threads claim the
+        // buckets one by one.
+        std::atomic<std::uint64_t> next_bucket{0};
+        thread_pool.Run([&](std::size_t) {
+            std::vector<std::uint64_t> positions;
+            for (std::uint64_t b = next_bucket++; b < bucket_count; b = next_bucket++) {
+                const std::uint64_t first_vertex = b * bucket_width;
+                const std::uint64_t last_vertex = std::min(first_vertex + bucket_width, vertex_count);
+                const Edge *begin = bucketed.get() + bucket_offsets[b];
+                const Edge *end = bucketed.get() + bucket_offsets[b + 1];
+
+                // Count the out-degrees, shifted by one so that the prefix sum yields the offsets.
+                for (const Edge *edge = begin; edge != end; ++edge) {
+                    ++offsets[origin(*edge) + 1];
+                }
+                positions.assign(1, bucket_offsets[b]);
+                for (std::uint64_t v = first_vertex; v < last_vertex; ++v) {
+                    offsets[v + 1] += positions.back();
+                    positions.push_back(offsets[v + 1]);
+                }
+
+                // Scatter the edges, positions[v - first_vertex] is the next free slot of the vertex v.
+                for (const Edge *edge = begin; edge != end; ++edge) {
+                    targets[positions[origin(*edge) - first_vertex]++] =
+                            VertexId(transpose ? edge->source_vertex : edge->destination_vertex);
+                }
+            }
+        });
+
+        return CsrAdjacency(std::move(offsets), std::move(targets));
+    }
+
+    std::uint64_t CsrAdjacency::VertexCount() const {
+        return storage_ == nullptr ? offsets_->size() - 1 : stored_vertex_count_;
+    }
+
+    std::uint64_t CsrAdjacency::EdgeCount() const {
+        return offsetsData()[VertexCount()];
+    }
+
+    MemoryFootprint CsrAdjacency::Footprint() const {
+        MemoryFootprint footprint;
+        if (storage_ != nullptr) {
+            footprint.AddBuffer<std::uint64_t>(stored_vertex_count_ + 1, stored_vertex_count_ + 1);
+            footprint.AddBuffer<VertexId>(EdgeCount(), EdgeCount());
+            return footprint;
+        }
+        footprint.AddBuffer<std::uint64_t>(offsets_->size(), offsets_->capacity());
+        footprint.AddBuffer<VertexId>(targets_->size(), targets_->capacity());
+        return footprint;
+    }
+
+    std::uint64_t CsrAdjacency::Degree(const std::uint64_t vertex_id) const {
+        const std::uint64_t *offsets = offsetsData();
+        return offsets[vertex_id + 1] - offsets[vertex_id];
+    }
+
+    std::uint64_t CsrAdjacency::AddVertex() {
+        checkVertexCapacity(VertexCount());
+        materialize();
+        auto &offsets = unshare(offsets_);
+        offsets.push_back(targets_->size());
+        return offsets.size() - 2;
+    }
+
+    void CsrAdjacency::AddEdge(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id) {
+        materialize();
+        const std::uint64_t position = (*offsets_)[src_vertex_id + 1];
+        splice(targets_, position, position, VertexIdVector{VertexId(dst_vertex_id)});
+        auto &offsets = unshare(offsets_);
+        for (auto v = src_vertex_id + 1; v < offsets.size(); ++v) {
+            ++offsets[v];
+        }
+    }
+
+    void CsrAdjacency::materialize() {
+        if (storage_ == nullptr) {
+            return;
+        }
+        offsets_ = std::make_shared<std::vector<std::uint64_t>>(stored_offsets_,
+                                                                stored_offsets_ + stored_vertex_count_ + 1);
+        targets_ = std::make_shared<VertexIdVector>(stored_targets_, stored_targets_ + offsets_->back());
+        storage_.reset();
+        stored_offsets_ = nullptr;
+        stored_targets_ = nullptr;
+        stored_vertex_count_ = 0;
+    }
+
+    DeltaCsrAdjacency::DeltaCsrAdjacency(const std::uint64_t merge_threshold) : DeltaCsrAdjacency(CsrAdjacency(),
+                                                                                                   merge_threshold) {
+    }
+
+    DeltaCsrAdjacency::DeltaCsrAdjacency(CsrAdjacency base, const std::uint64_t merge_threshold) :
+            base_(std::make_shared<const CsrAdjacency>(std::move(base))),
+            merge_threshold_(merge_threshold) {
+        for (std::uint64_t v = 0; v < base_->VertexCount(); ++v) {
+            deltas_.PushBack(VertexIdVector());
+        }
+    }
+
+    DeltaCsrAdjacency::~DeltaCsrAdjacency() {
+        if (pending_base_.valid()) {
+            pending_base_.wait();
+        }
+    }
+
+    DeltaCsrAdjacency::DeltaCsrAdjacency(const DeltaCsrAdjacency &other) : base_(other.base_),
+                                                                           deltas_(other.deltas_),
+                                                                           dirty_vertices_(other.dirty_vertices_),
+                                                                           delta_edge_count_(other.delta_edge_count_),
+                                                                           merge_threshold_(other.merge_threshold_) {
+    }
+
+    DeltaCsrAdjacency &DeltaCsrAdjacency::operator=(const DeltaCsrAdjacency &other) {
+        return *this = DeltaCsrAdjacency(other);
+    }
+
+    std::uint64_t DeltaCsrAdjacency::VertexCount() const {
+        return deltas_.Size();
+    }
+
+    std::uint64_t DeltaCsrAdjacency::EdgeCount() const {
+        return base_->EdgeCount() + delta_edge_count_;
+    }
+
+    std::uint64_t DeltaCsrAdjacency::DeltaEdgeCount() const {
+        return delta_edge_count_;
+    }
+
+    MemoryFootprint DeltaCsrAdjacency::Footprint() const {
+        MemoryFootprint footprint = base_->Footprint();
+        footprint += deltas_.Footprint();
+        for (std::uint64_t v = 0; v < deltas_.Size(); ++v) {
+            footprint.AddBuffer<VertexId>(deltas_[v].size(), deltas_[v].capacity());
+        }
+        footprint.AddBuffer<std::uint64_t>(dirty_vertices_.size(), dirty_vertices_.capacity());
+        footprint.AddBuffer<std::pair<std::uint64_t, std::uint64_t>>(pending_delta_sizes_.size(),
+                                                                     pending_delta_sizes_.capacity());
+        return footprint;
+    }
+
+    std::uint64_t DeltaCsrAdjacency::Degree(const std::uint64_t vertex_id) const {
+        const std::uint64_t base_degree = vertex_id < base_->VertexCount() ? base_->Degree(vertex_id) : 0;
+        return base_degree + deltas_[vertex_id].size();
+    }
+
+    std::uint64_t DeltaCsrAdjacency::AddVertex() {
+        checkVertexCapacity(deltas_.Size());
+        deltas_.PushBack(VertexIdVector());
+        return deltas_.Size() - 1;
+    }
+
+    void DeltaCsrAdjacency::AddEdge(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id) {
+        auto &delta = deltas_.Mutable(src_vertex_id);
+        if (delta.empty()) {
+            dirty_vertices_.push_back(src_vertex_id);
+        }
+        delta.push_back(VertexId(dst_vertex_id));
+        ++delta_edge_count_;
+
+        installMergedBase(false);
+        maybeStartMerge();
+    }
+
+    void DeltaCsrAdjacency::Compact() {
+        installMergedBase(true);
+        if (delta_edge_count_ == 0) {
+            return;
+        }
+
+        std::vector<VertexDelta> deltas;
+        deltas.reserve(dirty_vertices_.size());
+        for (const auto vertex: dirty_vertices_) {
+            auto &delta = deltas_.Mutable(vertex);
+            deltas.emplace_back(vertex, std::move(delta));
+            delta.clear();
+        }
+        base_ = merge(base_, deltas_.Size(), deltas);
+        dirty_vertices_.clear();
+        delta_edge_count_ = 0;
+    }
+
+    void DeltaCsrAdjacency::installMergedBase(const bool wait) {
+        if (!pending_base_.valid()) {
+            return;
+        }
+        if (!wait && pending_base_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+
+        base_ = pending_base_.get();
+
+        // Drop the merged prefix of every delta buffer, the edges created during the merge stay in the buffers.
+        for (const auto &[vertex, merged_size]: pending_delta_sizes_) {
+            auto &delta = deltas_.Mutable(vertex);
+            delta.erase(delta.begin(), delta.begin() + std::int64_t(merged_size));
+            delta_edge_count_ -= merged_size;
+        }
+        pending_delta_sizes_.clear();
+
+        dirty_vertices_.erase(std::remove_if(dirty_vertices_.begin(), dirty_vertices_.end(),
+                                             [this](const std::uint64_t vertex) { return deltas_[vertex].empty(); }),
+                              dirty_vertices_.end());
+    }
+
+    void DeltaCsrAdjacency::maybeStartMerge() {
+        if (pending_base_.valid() || delta_edge_count_ < std::max(merge_threshold_, base_->EdgeCount() / 8)) {
+            return;
+        }
+
+        // Copy the delta buffers, so that the edge insertion can continue while the merge is running.
+        std::vector<VertexDelta> deltas;
+        deltas.reserve(dirty_vertices_.size());
+        for (const auto vertex: dirty_vertices_) {
+            deltas.emplace_back(vertex, deltas_[vertex]);
+            pending_delta_sizes_.emplace_back(vertex, deltas_[vertex].size());
+        }
+
+        pending_base_ = std::async(std::launch::async, &DeltaCsrAdjacency::merge, base_, deltas_.Size(),
+                                   std::move(deltas));
+    }
+
+    std::shared_ptr<const CsrAdjacency> DeltaCsrAdjacency::merge(std::shared_ptr<const CsrAdjacency> base,
+                                                                  const std::uint64_t vertex_count,
+                                                                  const std::vector<VertexDelta> &deltas) {
+        std::vector<const VertexIdVector *> vertex_deltas(vertex_count, nullptr);
+        for (const auto &[vertex, delta]: deltas) {
+            vertex_deltas[vertex] = &delta;
+        }
+
+        std::vector<std::uint64_t> offsets(vertex_count + 1, 0);
+        for (std::uint64_t v = 0; v < vertex_count; ++v) {
+            std::uint64_t degree = v < base->VertexCount() ? base->Degree(v) : 0;
+            if (vertex_deltas[v] != nullptr) {
+                degree += vertex_deltas[v]->size();
+            }
+            offsets[v + 1] = offsets[v] + degree;
+        }
+
+        VertexIdVector targets(offsets.back());
+        for (std::uint64_t v = 0; v < vertex_count; ++v) {
+            VertexId *position = targets.data() + offsets[v];
+            if (v < base->VertexCount()) {
+                base->ForEachNeighbour(v, [&position](const std::uint64_t neighbour) {
+                    *position++ = VertexId(neighbour);
+                    return true;
+                });
+            }
+            if (vertex_deltas[v] != nullptr) {
+                std::copy(vertex_deltas[v]->begin(), vertex_deltas[v]->end(), position);
+            }
+        }
+
+        return std::make_shared<const CsrAdjacency>(std::move(offsets), std::move(targets));
+    }
+
+    ConcurrentAdjacency::EdgeBlock::EdgeBlock(const std::uint64_t block_capacity) :
+            capacity(block_capacity), targets(new std::atomic<VertexId>[block_capacity]) {
+        for (std::uint64_t i = 0; i < capacity; ++i) {
+            targets[i].store(kEmptySlot, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentAdjacency::ConcurrentAdjacency() {
+        for (auto &segment: segments_) {
+            segment.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentAdjacency::~ConcurrentAdjacency() {
+        release();
+    }
+
+    ConcurrentAdjacency::ConcurrentAdjacency(const ConcurrentAdjacency &other) : ConcurrentAdjacency() {
+        const std::uint64_t vertex_count = other.VertexCount();
+        for (std::uint64_t v = 0; v < vertex_count; ++v) {
+            AddVertex();
+            other.ForEachNeighbour(v, [this, v](const std::uint64_t neighbour) {
+                AddEdge(v, neighbour);
+                return true;
+            });
+        }
+    }
+
+    ConcurrentAdjacency::ConcurrentAdjacency(ConcurrentAdjacency &&other) noexcept: ConcurrentAdjacency() {
+        swap(other);
+    }
+
+    ConcurrentAdjacency &ConcurrentAdjacency::operator=(ConcurrentAdjacency other) noexcept {
+        // The previous table is freed with the argument.
+        swap(other);
+        return *this;
+    }
+
+    void ConcurrentAdjacency::swap(ConcurrentAdjacency &other) noexcept {
+        for (std::size_t k = 0; k < kSegmentCount; ++k) {
+            VertexRecord *segment = segments_[k].load(std::memory_order_relaxed);
+            segments_[k].store(other.segments_[k].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.segments_[k].store(segment, std::memory_order_relaxed);
+        }
+        const std::uint64_t vertex_count = vertex_count_.load(std::memory_order_relaxed);
+        vertex_count_.store(other.vertex_count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.vertex_count_.store(vertex_count, std::memory_order_relaxed);
+        const std::uint64_t edge_count = edge_count_.load(std::memory_order_relaxed);
+        edge_count_.store(other.edge_count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.edge_count_.store(edge_count, std::memory_order_relaxed);
+    }
+
+    std::uint64_t ConcurrentAdjacency::VertexCount() const {
+        return vertex_count_.load(std::memory_order_acquire);
+    }
+
+    std::uint64_t ConcurrentAdjacency::EdgeCount() const {
+        return edge_count_.load(std::memory_order_relaxed);
+    }
+
+    MemoryFootprint ConcurrentAdjacency::Footprint() const {
+        MemoryFootprint footprint;
+        const std::uint64_t vertex_count = VertexCount();
+        for (std::size_t k = 0; k < kSegmentCount; ++k) {
+            const VertexRecord *records = segments_[k].load(std::memory_order_acquire);
+            if (records == nullptr) {
+                continue;
+            }
+            // The records past the last vertex are allocated ahead of the vertices.
+            const std::uint64_t first_vertex = kFirstSegmentSize * ((std::uint64_t(1) << k) - 1);
+            const std::uint64_t segment_size = kFirstSegmentSize << k;
+            const std::uint64_t used = std::min(segment_size, vertex_count - std::min(vertex_count, first_vertex));
+            footprint.AddBuffer<VertexRecord>(used, segment_size);
+            for (std::uint64_t i = 0; i < segment_size; ++i) {
+                for (const EdgeBlock *block = records[i].head.load(std::memory_order_acquire); block != nullptr;
+                     block = block->next.load(std::memory_order_acquire)) {
+                    footprint.AddBuffer<EdgeBlock>(1, 1);
+                    footprint.AddBuffer<std::atomic<VertexId>>(
+                            std::min(block->reserved.load(std::memory_order_relaxed), block->capacity),
+                            block->capacity);
+                }
+            }
+        }
+        return footprint;
+    }
+
+    std::uint64_t ConcurrentAdjacency::Degree(const std::uint64_t vertex_id) const {
+        const VertexRecord *record = findRecord(vertex_id);
+        return record == nullptr ? 0 : record->degree.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t ConcurrentAdjacency::AddVertex() {
+        // The record is allocated lazily by the first edge, a vertex without edges needs no memory beyond its ID. The
+        // count is never advanced past the limit, so that no reader observes a vertex ID that does not fit.
+        std::uint64_t vertex_count = vertex_count_.load(std::memory_order_relaxed);
+        do {
+            checkVertexCapacity(vertex_count);
+        } while (!vertex_count_.compare_exchange_weak(vertex_count, vertex_count + 1, std::memory_order_acq_rel,
+                                                      std::memory_order_relaxed));
+        return vertex_count;
+    }
+
+    void ConcurrentAdjacency::AddEdge(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id) {
+        VertexRecord &vertex = record(src_vertex_id);
+
+        EdgeBlock *block = vertex.tail.load(std::memory_order_acquire);
+        if (block == nullptr) {
+            // Install the first block, the losing thread uses the block of the winner.
+            auto *first_block = new EdgeBlock(kFirstBlockCapacity);
+            EdgeBlock *head = nullptr;
+            if (vertex.head.compare_exchange_strong(head, first_block, std::memory_order_acq_rel)) {
+                head = first_block;
+            } else {
+                delete first_block;
+            }
+            EdgeBlock *tail = nullptr;
+            vertex.tail.compare_exchange_strong(tail, head, std::memory_order_acq_rel);
+            block = vertex.tail.load(std::memory_order_acquire);
+        }
+
+        while (true) {
+            const std::uint64_t slot = block->reserved.fetch_add(1, std::memory_order_relaxed);
+            if (slot < block->capacity) {
+                block->targets[slot].store(VertexId(dst_vertex_id), std::memory_order_release);
+                vertex.degree.fetch_add(1, std::memory_order_relaxed);
+                edge_count_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // The block is full, link the next one unless another thread already did.
+            EdgeBlock *next = block->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                auto *next_block = new EdgeBlock(std::min(block->capacity * 2, kMaxBlockCapacity));
+                if (block->next.compare_exchange_strong(next, next_block, std::memory_order_acq_rel)) {
+                    next = next_block;
+                } else {
+                    delete next_block;
+                }
+            }
+
+            // Help to advance the tail, it fails harmlessly if another thread advanced it already.
+            EdgeBlock *expected_tail = block;
+            vertex.tail.compare_exchange_strong(expected_tail, next, std::memory_order_acq_rel);
+            block = next;
+        }
+    }
+
+    std::pair<std::size_t, std::uint64_t> ConcurrentAdjacency::locate(const std::uint64_t vertex_id) {
+        const std::uint64_t chunk = vertex_id / kFirstSegmentSize + 1;
+        const std::size_t segment = 63 - __builtin_clzll(chunk);
+        return {segment, vertex_id - kFirstSegmentSize * ((std::uint64_t(1) << segment) - 1)};
+    }
+
+    ConcurrentAdjacency::VertexRecord &ConcurrentAdjacency::record(const std::uint64_t vertex_id) {
+        const auto [segment_index, offset] = locate(vertex_id);
+        auto &segment = segments_[segment_index];
+
+        VertexRecord *records = segment.load(std::memory_order_acquire);
+        if (records == nullptr) {
+            // Allocate the segment, the losing thread frees its allocation and uses the segment of the winner.
+            auto *new_records = new VertexRecord[kFirstSegmentSize << segment_index];
+            if (segment.compare_exchange_strong(records, new_records, std::memory_order_acq_rel)) {
+                records = new_records;
+            } else {
+                delete[] new_records;
+            }
+        }
+        return records[offset];
+    }
+
+    const ConcurrentAdjacency::VertexRecord *ConcurrentAdjacency::findRecord(const std::uint64_t vertex_id) const {
+        const auto [segment_index, offset] = locate(vertex_id);
+        const VertexRecord *records = segments_[segment_index].load(std::memory_order_acquire);
+        return records == nullptr ? nullptr : records + offset;
+    }
+
+    void ConcurrentAdjacency::release() {
+        for (std::size_t k = 0; k < kSegmentCount; ++k) {
+            VertexRecord *records = segments_[k].load(std::memory_order_relaxed);
+            if (records == nullptr) {
+                continue;
+            }
+            for (std::uint64_t i = 0; i < (kFirstSegmentSize << k); ++i) {
+                for (EdgeBlock *block = records[i].head.load(std::memory_order_relaxed); block != nullptr;) {
+                    EdgeBlock *next = block->next.load(std::memory_order_relaxed);
+                    delete block;
+                    block = next;
+                }
+            }
+            delete[] records;
+            segments_[k].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    CompressedCsrAdjacency::CompressedCsrAdjacency() :
+            offsets_(std::make_shared<std::vector<std::uint64_t>>(1, 0)),
+            data_(std::make_shared<std::vector<std::uint8_t>>(kPadding, 0)) {
+    }
+
+    CompressedCsrAdjacency CompressedCsrAdjacency::FromCsr(const CsrAdjacency &csr, ThreadPool *const thread_pool) {
+        const std::uint64_t vertex_count = csr.VertexCount();
+        const std::uint64_t block_count = (vertex_count + kBlockSize - 1) / kBlockSize;
+
+        CompressedCsrAdjacency result;
+        auto &offsets = *result.offsets_;
+        auto &data = *result.data_;
+        offsets.assign(vertex_count + 1, 0);
+        result.edge_count_ = csr.EdgeCount();
+
+        // Every block is encoded into its own buffer, offsets_ receives the positions within the buffer first.
+        std::vector<std::vector<std::uint8_t>> buffers(block_count);
+        const auto encode_block = [&](const std::uint64_t block) {
+            VertexIdVector neighbours;
+            auto &buffer = buffers[block];
+            const std::uint64_t end = std::min(vertex_count, (block + 1) * kBlockSize);
+            for (std::uint64_t v = block * kBlockSize; v < end; ++v) {
+                neighbours.clear();
+                csr.ForEachNeighbour(v, [&neighbours](const std::uint64_t neighbour) {
+                    neighbours.push_back(VertexId(neighbour));
+                    return true;
+                });
+                std::sort(neighbours.begin(), neighbours.end());
+                offsets[v] = buffer.size();
+                encode(v, neighbours, buffer);
+            }
+        };
+
+        // The threads claim the blocks one by one, so the skewed degrees do not leave threads idle.
+        const auto for_each_block = [&](const auto &process_block) {
+            if (thread_pool == nullptr) {
+                for (std::uint64_t block = 0; block < block_count; ++block) {
+                    process_block(block);
+                }
+                return;
+            }
+            std::atomic<std::uint64_t> next_block{0};
+            thread_pool->Run([&](std::size_t) {
+                for (auto block = next_block++; block < block_count; block = next_block++) {
+                    process_block(block);
+                }
+            });
+        };
+
+        for_each_block(encode_block);
+        std::vector<std::uint64_t> block_offsets(block_count + 1, 0);
+        for (std::uint64_t block = 0; block < block_count; ++block) {
+            block_offsets[block + 1] = block_offsets[block] + buffers[block].size();
+        }
+
+        // Concatenate the buffers and shift the offsets by the positions of their blocks.
+        data.assign(block_offsets.back() + kPadding, 0);
+        const auto place_block = [&](const std::uint64_t block) {
+            const std::uint64_t end = std::min(vertex_count, (block + 1) * kBlockSize);
+            for (std::uint64_t v = block * kBlockSize; v < end; ++v) {
+                offsets[v] += block_offsets[block];
+            }
+            std::copy(buffers[block].begin(), buffers[block].end(), data.begin() + std::int64_t(block_offsets[block]));
+            std::vector<std::uint8_t>().swap(buffers[block]);
+        };
+        for_each_block(place_block);
+        offsets[vertex_count] = block_offsets.back();
+        return result;
+    }
+
+    std::uint64_t CompressedCsrAdjacency::VertexCount() const {
+        return offsets_->size() - 1;
+    }
+
+    std::uint64_t CompressedCsrAdjacency::EdgeCount() const {
+        return edge_count_;
+    }
+
+    std::uint64_t CompressedCsrAdjacency::EncodedBytes() const {
+        return data_->size() + offsets_->size() * sizeof(std::uint64_t);
+    }
+
+    MemoryFootprint CompressedCsrAdjacency::Footprint() const {
+        MemoryFootprint footprint;
+        footprint.AddBuffer<std::uint64_t>(offsets_->size(), offsets_->capacity());
+        footprint.AddBuffer<std::uint8_t>(data_->size(), data_->capacity());
+        return footprint;
+    }
+
+    std::uint64_t CompressedCsrAdjacency::Degree(const std::uint64_t vertex_id) const {
+        const std::uint8_t *it = data_->data() + (*offsets_)[vertex_id];
+        return readVarint(it);
+    }
+
+    std::uint64_t CompressedCsrAdjacency::AddVertex() {
+        checkVertexCapacity(VertexCount());
+        // The stream of a vertex without neighbours is the single zero degree byte, which takes the place of the
+        // first padding byte.
+        unshare(data_).push_back(0);
+        auto &offsets = unshare(offsets_);
+        offsets.push_back(offsets.back() + 1);
+        return VertexCount() - 1;
+    }
+
+    void CompressedCsrAdjacency::AddEdge(const std::uint64_t src_vertex_id, const std::uint64_t dst_vertex_id) {
+        VertexIdVector neighbours;
+        decode(src_vertex_id, neighbours);
+        neighbours.insert(std::upper_bound(neighbours.begin(), neighbours.end(), VertexId(dst_vertex_id)),
+                          VertexId(dst_vertex_id));
+        std::vector<std::uint8_t> stream;
+        encode(src_vertex_id, neighbours, stream);
+
+        splice(data_, (*offsets_)[src_vertex_id], (*offsets_)[src_vertex_id + 1], stream);
+        auto &offsets = unshare(offsets_);
+        const std::uint64_t old_size = offsets[src_vertex_id + 1] - offsets[src_vertex_id];
+        for (auto v = src_vertex_id + 1; v < offsets.size(); ++v) {
+            offsets[v] = offsets[v] - old_size + stream.size();
+        }
+        ++edge_count_;
+    }
+
+    void CompressedCsrAdjacency::encode(const std::uint64_t vertex_id, const VertexIdVector &neighbours,
+                                        std::vector<std::uint8_t> &buffer) {
+        for (std::uint64_t degree = neighbours.size();; degree >>= 7) {
+            if (degree < 0x80) {
+                buffer.push_back(std::uint8_t(degree));
+                break;
+            }
+            buffer.push_back(std::uint8_t(degree | 0x80));
+        }
+
+        std::uint64_t previous = vertex_id;
+        for (std::size_t group = 0; group < neighbours.size(); group += kGroupSize) {
+            const std::size_t control_position = buffer.size();
+            buffer.push_back(0);
+            const std::size_t group_end = std::min<std::size_t>(neighbours.size(), group + kGroupSize);
+            for (std::size_t i = group; i < group_end; ++i) {
+                std::uint64_t gap;
+                if (i == 0) {
+                    const auto difference = std::int64_t(neighbours[i] - previous);
+                    gap = (std::uint64_t(difference) << 1) ^ std::uint64_t(difference >> 63);
+                } else {
+                    gap = neighbours[i] - previous;
+                }
+                previous = neighbours[i];
+
+                unsigned code = 0;
+                while (code < 3 && (gap & ~kGapMasks[code]) != 0) {
+                    ++code;
+                }
+                buffer[control_position] |= std::uint8_t(code << (2 * (i - group)));
+                for (std::size_t byte = 0; byte < (std::size_t(1) << code); ++byte) {
+                    buffer.push_back(std::uint8_t(gap >> (8 * byte)));
+                }
+            }
+        }
+    }
+
+    void CompressedCsrAdjacency::decode(const std::uint64_t vertex_id, VertexIdVector &neighbours) const {
+        neighbours.clear();
+        neighbours.reserve(Degree(vertex_id) + 1);
+        ForEachNeighbour(vertex_id, [&neighbours](const std::uint64_t neighbour) {
+            neighbours.push_back(VertexId(neighbour));
+            return true;
+        });
+    }
+
+} // namespace graph_util
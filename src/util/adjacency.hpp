@@ -0,0 +1,656 @@
+#ifndef GRAPHSTORE_ADJACENCY_HPP
+#define GRAPHSTORE_ADJACENCY_HPP
+
+#include "graph_util.hpp"
+#include "memory_usage.hpp"
+#include "shared_chunk_vector.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <vector>
+#include <variant>
+#include <memory>
+#include <future>
+#include <utility>
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+namespace graph_util {
+
+    ///
+    /// @brief AdjacencyList stores the outgoing edges of each vertex in a separate vector.
+    /// Edge insertion is amortized O(1), but every vertex owns its own heap allocation, so a traversal has to follow
+    /// one pointer per expanded vertex.
+    ///
+    /// The vectors are grouped into the chunks of SharedChunkVector, which are shared by the copies of the adjacency:
+    /// the first insertion into a shared chunk copies the vectors of its 1024 vertices only.
+    ///
+    class AdjacencyList {
+    public:
+        /// @return The number of vertices stored in the adjacency list
+        std::uint64_t VertexCount() const;
+
+        /// @return The number of edges stored in the adjacency list
+        std::uint64_t EdgeCount() const;
+
+        /// @return The memory of the vectors, counted by their capacity
+        MemoryFootprint Footprint() const;
+
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @return The number of outgoing edges of the vertex
+        ///
+        std::uint64_t Degree(std::uint64_t vertex_id) const;
+
+        ///
+        /// @brief Appends a vertex without outgoing edges.
+        /// @return The ID of the appended vertex
+        /// @throws std::length_error if the adjacency already holds kMaxVertexCount vertices
+        ///
+        std::uint64_t AddVertex();
+
+        ///
+        /// @param src_vertex_id The origin vertex ID of the edge, should be valid
+        /// @param dst_vertex_id The destination vertex ID of the edge
+        ///
+        void AddEdge(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id);
+
+        ///
+        /// @brief Calls visitor for each outgoing neighbour of the vertex in insertion order.
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @param visitor Callable taking the neighbour ID and returning false to stop the iteration
+        /// @return false if the iteration was stopped by the visitor, otherwise returns true
+        ///
+        template<typename Visitor>
+        bool ForEachNeighbour(std::uint64_t vertex_id, Visitor &&visitor) const {
+            for (const VertexId neighbour: neighbours_[vertex_id]) {
+                if (!visitor(neighbour)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        // i-th element of neighbours_ vector is the adjacency list for vertex i.
+        SharedChunkVector<VertexIdVector> neighbours_;
+
+        std::uint64_t edge_count_ = 0;
+    };
+
+    ///
+    /// @brief CsrAdjacency stores the edges in Compressed Sparse Row format: the neighbours of all vertices are kept in
+    /// one contiguous targets array, and the neighbours of the vertex v are targets[offsets[v]..offsets[v + 1]).
+    ///
+    /// The layout has no per-vertex allocations and the traversal reads contiguous memory. The price is edge
+    /// insertion, which shifts the tail of the targets array and takes O(V+E) time, so the layout is meant for graphs
+    /// that are loaded in bulk with CsrAdjacency::FromEdges.
+    ///
+    /// The arrays are shared by the copies of the adjacency. The edge insertion into a shared array writes the result
+    /// into a new array in the same pass as the shift, so it takes O(V+E) time as well, and the vertex insertion
+    /// copies the shared offsets array in O(V) time.
+    ///
+    class CsrAdjacency {
+    public:
+        /// Creates the empty adjacency
+        CsrAdjacency();
+
+        ///
+        /// @brief Creates the adjacency from already built arrays.
+        /// @param offsets The offsets array with V + 1 non-decreasing elements, the first one should be 0
+        /// @param targets The targets array with offsets.back() elements
+        ///
+        CsrAdjacency(std::vector<std::uint64_t> offsets, VertexIdVector targets);
+
+        ///
+        /// @brief Creates the adjacency reading the arrays in place, for example from a mapped file. The arrays are
+        /// copied only by the first modification.
+        /// @param storage The owner of the arrays, kept alive by the adjacency and its copies
+        /// @param offsets The offsets array with vertex_count + 1 non-decreasing elements, the first one should be 0
+        /// @param vertex_count The number of vertices in the graph
+        /// @param targets The targets array with offsets[vertex_count] elements
+        ///
+        CsrAdjacency(std::shared_ptr<const void> storage, const std::uint64_t *offsets, std::uint64_t vertex_count,
+                     const VertexId *targets);
+
+        /// The smallest number of edges FromEdges builds on the thread pool, smaller inputs are built serially
+        static constexpr std::size_t kParallelBuildThreshold = 1 << 16;
+
+        ///
+        /// @brief Builds the adjacency with a counting sort over the edges. Neighbours of every vertex keep the order
+        /// in which they appear in the edges vector.
+        ///
+        /// With a thread pool, large inputs are sorted in two stable passes on all threads: the edges are first
+        /// scattered into buckets of consecutive origin vertices, then every bucket counts the degrees of its
+        /// vertices, sums them up and scatters its edges into the targets. The result is the same as of the serial
+        /// build.
+        ///
+        /// @param vertex_count The number of vertices in the graph
+        /// @param edges The vector of directed edges, all endpoints should be less than vertex_count
+        /// @param transpose Build the adjacency of the reversed edges
+        /// @param thread_pool The threads to build on, nullptr builds on the calling thread
+        /// @return The built adjacency
+        ///
+        static CsrAdjacency FromEdges(std::uint64_t vertex_count, const std::vector<Edge> &edges,
+                                      bool transpose = false, ThreadPool *thread_pool = nullptr);
+
+        /// @return The number of vertices stored in the adjacency
+        std::uint64_t VertexCount() const;
+
+        /// @return The number of edges stored in the adjacency
+        std::uint64_t EdgeCount() const;
+
+        /// @return The memory of the arrays, counted by their capacity, or by their size if they are read in place
+        /// from a snapshot file
+        MemoryFootprint Footprint() const;
+
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @return The number of outgoing edges of the vertex
+        ///
+        std::uint64_t Degree(std::uint64_t vertex_id) const;
+
+        ///
+        /// @brief Appends a vertex without outgoing edges.
+        /// @return The ID of the appended vertex
+        /// @throws std::length_error if the adjacency already holds kMaxVertexCount vertices
+        ///
+        std::uint64_t AddVertex();
+
+        ///
+        /// @param src_vertex_id The origin vertex ID of the edge, should be valid
+        /// @param dst_vertex_id The destination vertex ID of the edge
+        ///
+        void AddEdge(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id);
+
+        ///
+        /// @brief Calls visitor for each outgoing neighbour of the vertex in insertion order.
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @param visitor Callable taking the neighbour ID and returning false to stop the iteration
+        /// @return false if the iteration was stopped by the visitor, otherwise returns true
+        ///
+        template<typename Visitor>
+        bool ForEachNeighbour(std::uint64_t vertex_id, Visitor &&visitor) const {
+            const std::uint64_t *offsets = offsetsData();
+            const VertexId *it = targetsData() + offsets[vertex_id];
+            const VertexId *end = targetsData() + offsets[vertex_id + 1];
+            for (; it != end; ++it) {
+                if (!visitor(*it)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        // The number of vertex buckets per thread of the parallel build, more buckets balance the skewed degrees.
+        static constexpr std::size_t kBucketsPerThread = 8;
+
+        // Builds the adjacency on the thread pool, see FromEdges.
+        static CsrAdjacency fromEdgesParallel(std::uint64_t vertex_count, const std::vector<Edge> &edges,
+                                              bool transpose, ThreadPool &thread_pool);
+
+        // offsets_[v] is the index of the first neighbour of the vertex v in targets_, offsets_ has V + 1 elements.
+        std::shared_ptr<std::vector<std::uint64_t>> offsets_;
+
+        // Neighbours of all vertices, grouped by the origin vertex.
+        std::shared_ptr<VertexIdVector> targets_;
+
+        // The owner of the arrays read in place, offsets_ and targets_ are null while it's set.
+        std::shared_ptr<const void> storage_;
+        const std::uint64_t *stored_offsets_ = nullptr;
+        const VertexId *stored_targets_ = nullptr;
+        std::uint64_t stored_vertex_count_ = 0;
+
+        const std::uint64_t *offsetsData() const {
+            return storage_ == nullptr ? offsets_->data() : stored_offsets_;
+        }
+
+        const VertexId *targetsData() const {
+            return storage_ == nullptr ? targets_->data() : stored_targets_;
+        }
+
+        // Copies the arrays read in place into offsets_ and targets_, so that they can be modified.
+        void materialize();
+    };
+
+    ///
+    /// @brief DeltaCsrAdjacency is a mutable CSR: a read-optimized CsrAdjacency base plus small append-only delta
+    /// buffers per vertex for the edges created after the base was built.
+    ///
+    /// Edge insertion appends to the delta buffer of the origin vertex in amortized O(1) time. Once the delta buffers
+    /// hold more than max(merge_threshold, E / 8) edges, a background task merges them with the base into a fresh CSR,
+    /// which is installed by the next mutation after the task finishes. The traversal therefore reads mostly
+    /// contiguous memory, and the neighbours of every vertex keep their insertion order across merges.
+    ///
+    class DeltaCsrAdjacency {
+    public:
+        /// The default minimal number of delta edges that triggers a merge.
+        static constexpr std::uint64_t kDefaultMergeThreshold = 1 << 16;
+
+        ///
+        /// @brief Creates the empty adjacency
+        /// @param merge_threshold The minimal number of delta edges that triggers a background merge
+        ///
+        explicit DeltaCsrAdjacency(std::uint64_t merge_threshold = kDefaultMergeThreshold);
+
+        ///
+        /// @brief Creates the adjacency on top of an already built CSR base.
+        /// @param base The initial base of the adjacency
+        /// @param merge_threshold The minimal number of delta edges that triggers a background merge
+        ///
+        DeltaCsrAdjacency(CsrAdjacency base, std::uint64_t merge_threshold);
+
+        /// Waits for the running background merge, if any.
+        ~DeltaCsrAdjacency();
+
+        ///
+        /// @brief Creates a copy that shares the immutable base and the chunks of the delta buffers with the other
+        /// adjacency, the first insertion into a shared chunk copies its buffers. The background merge of the other
+        /// adjacency is not copied, its edges stay in the delta buffers of the copy.
+        ///
+        DeltaCsrAdjacency(const DeltaCsrAdjacency &other);
+
+        DeltaCsrAdjacency(DeltaCsrAdjacency &&other) noexcept = default;
+
+        DeltaCsrAdjacency &operator=(const DeltaCsrAdjacency &other);
+
+        DeltaCsrAdjacency &operator=(DeltaCsrAdjacency &&other) noexcept = default;
+
+        /// @return The number of vertices stored in the adjacency
+        std::uint64_t VertexCount() const;
+
+        /// @return The number of edges stored in the adjacency
+        std::uint64_t EdgeCount() const;
+
+        /// @return The memory of the base and the delta buffers, counted by their capacity. The base may be shared
+        /// with the copies of the adjacency.
+        MemoryFootprint Footprint() const;
+
+        /// @return The number of edges that are stored in the delta buffers and not yet merged into the base
+        std::uint64_t DeltaEdgeCount() const;
+
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @return The number of outgoing edges of the vertex
+        ///
+        std::uint64_t Degree(std::uint64_t vertex_id) const;
+
+        ///
+        /// @brief Appends a vertex without outgoing edges.
+        /// @return The ID of the appended vertex
+        /// @throws std::length_error if the adjacency already holds kMaxVertexCount vertices
+        ///
+        std::uint64_t AddVertex();
+
+        ///
+        /// @param src_vertex_id The origin vertex ID of the edge, should be valid
+        /// @param dst_vertex_id The destination vertex ID of the edge
+        ///
+        void AddEdge(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id);
+
+        ///
+        /// @brief Waits for the running background merge and synchronously merges the remaining delta buffers, so that
+        /// all edges are stored in the base afterwards.
+        ///
+        void Compact();
+
+        ///
+        /// @brief Calls visitor for each outgoing neighbour of the vertex in insertion order, the base neighbours are
+        /// visited before the delta buffer.
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @param visitor Callable taking the neighbour ID and returning false to stop the iteration
+        /// @return false if the iteration was stopped by the visitor, otherwise returns true
+        ///
+        template<typename Visitor>
+        bool ForEachNeighbour(std::uint64_t vertex_id, Visitor &&visitor) const {
+            // Vertices created after the base was built have no base neighbours.
+            if (vertex_id < base_->VertexCount() && !base_->ForEachNeighbour(vertex_id, visitor)) {
+                return false;
+            }
+            for (const VertexId neighbour: deltas_[vertex_id]) {
+                if (!visitor(neighbour)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        // Delta edges of one vertex, handed over to the background merge.
+        using VertexDelta = std::pair<std::uint64_t, VertexIdVector>;
+
+        // The immutable base, shared with the background merge while it runs.
+        std::shared_ptr<const CsrAdjacency> base_;
+
+        // deltas_[v] holds the edges of the vertex v created after the base was built, in insertion order.
+        SharedChunkVector<VertexIdVector> deltas_;
+
+        // The vertices with non-empty delta buffers.
+        VertexVector dirty_vertices_;
+
+        std::uint64_t delta_edge_count_ = 0;
+
+        std::uint64_t merge_threshold_;
+
+        // The result of the running background merge, invalid if no merge is running.
+        std::future<std::shared_ptr<const CsrAdjacency>> pending_base_;
+
+        // The number of delta edges per vertex that are merged by the running background merge.
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> pending_delta_sizes_;
+
+        // Installs the result of the finished background merge, if wait is true waits for the running merge.
+        void installMergedBase(bool wait);
+
+        // Starts the background merge if the delta buffers crossed the threshold and no merge is running.
+        void maybeStartMerge();
+
+        // Copies the base and appends the delta edges to the neighbours of the corresponding vertices.
+        static std::shared_ptr<const CsrAdjacency> merge(std::shared_ptr<const CsrAdjacency> base,
+                                                         std::uint64_t vertex_count,
+                                                         const std::vector<VertexDelta> &deltas);
+    };
+
+    ///
+    /// @brief ConcurrentAdjacency supports vertex and edge insertion from many threads at once without locks.
+    ///
+    /// The vertices are stored in a segmented table, the segment k holds kFirstSegmentSize * 2^k vertices and is
+    /// allocated on first use, so the table grows without relocating the existing vertices. The vertex IDs are
+    /// allocated with an atomic counter. The edges of every vertex are stored in a linked list of blocks of growing
+    /// capacity: an edge is appended by reserving a slot of the last block with an atomic increment, and the thread
+    /// that finds the last block full links the next one with compare-and-swap. The blocks are freed only with the
+    /// adjacency, so the readers never follow a dangling pointer.
+    ///
+    /// The traversal may run concurrently with the insertion, it then observes any subset of the edges that are being
+    /// inserted. The neighbours of every vertex keep the insertion order of each inserting thread.
+    ///
+    class ConcurrentAdjacency {
+    public:
+        /// Creates the empty adjacency
+        ConcurrentAdjacency();
+
+        /// Frees the vertex table and the edge blocks.
+        ~ConcurrentAdjacency();
+
+        ///
+        /// @brief Copies the vertices and the edges of the other adjacency, the insertion into the other adjacency
+        /// should not run concurrently.
+        ///
+        ConcurrentAdjacency(const ConcurrentAdjacency &other);
+
+        ConcurrentAdjacency(ConcurrentAdjacency &&other) noexcept;
+
+        ConcurrentAdjacency &operator=(ConcurrentAdjacency other) noexcept;
+
+        /// @return The number of vertices stored in the adjacency
+        std::uint64_t VertexCount() const;
+
+        /// @return The number of edges stored in the adjacency
+        std::uint64_t EdgeCount() const;
+
+        /// @return The memory of the allocated segments of the vertex table and of the edge blocks, the insertion
+        /// should not run concurrently
+        MemoryFootprint Footprint() const;
+
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @return The number of outgoing edges of the vertex
+        ///
+        std::uint64_t Degree(std::uint64_t vertex_id) const;
+
+        ///
+        /// @brief Appends a vertex without outgoing edges, may be called concurrently with AddVertex and AddEdge.
+        /// @return The ID of the appended vertex
+        /// @throws std::length_error if the adjacency already holds kMaxVertexCount vertices
+        ///
+        std::uint64_t AddVertex();
+
+        ///
+        /// @brief Appends the edge, may be called concurrently with AddVertex and AddEdge.
+        /// @param src_vertex_id The origin vertex ID of the edge, should be valid
+        /// @param dst_vertex_id The destination vertex ID of the edge
+        ///
+        void AddEdge(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id);
+
+        ///
+        /// @brief Calls visitor for each outgoing neighbour of the vertex.
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @param visitor Callable taking the neighbour ID and returning false to stop the iteration
+        /// @return false if the iteration was stopped by the visitor, otherwise returns true
+        ///
+        template<typename Visitor>
+        bool ForEachNeighbour(std::uint64_t vertex_id, Visitor &&visitor) const {
+            const VertexRecord *record = findRecord(vertex_id);
+            if (record == nullptr) {
+                return true;
+            }
+
+            for (const EdgeBlock *block = record->head.load(std::memory_order_acquire); block != nullptr;
+                 block = block->next.load(std::memory_order_acquire)) {
+                const std::uint64_t size = std::min(block->reserved.load(std::memory_order_relaxed), block->capacity);
+                for (std::uint64_t i = 0; i < size; ++i) {
+                    // The slot may be reserved by an insertion that did not store the neighbour yet.
+                    const VertexId neighbour = block->targets[i].load(std::memory_order_acquire);
+                    if (neighbour != kEmptySlot && !visitor(neighbour)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+    private:
+        // The number of vertices in the first segment of the vertex table, every next segment is twice as large.
+        static constexpr std::uint64_t kFirstSegmentSize = 1024;
+
+        // The number of segments, enough for 2^57 vertices.
+        static constexpr std::size_t kSegmentCount = 48;
+
+        // The capacity of the first edge block of a vertex, every next block is twice as large up to the maximum.
+        static constexpr std::uint64_t kFirstBlockCapacity = 4;
+        static constexpr std::uint64_t kMaxBlockCapacity = 1024;
+
+        // The value of the edge slot that is not written yet.
+        static constexpr VertexId kEmptySlot = kNoVertex;
+
+        // The fixed-size array of the neighbours of one vertex.
+        struct EdgeBlock {
+            explicit EdgeBlock(std::uint64_t block_capacity);
+
+            // The number of reserved slots, may exceed the capacity once the block is full.
+            std::atomic<std::uint64_t> reserved{0};
+            // The next block of the same vertex, linked once this one is full.
+            std::atomic<EdgeBlock *> next{nullptr};
+            const std::uint64_t capacity;
+            std::unique_ptr<std::atomic<VertexId>[]> targets;
+        };
+
+        // The edge blocks of one vertex.
+        struct VertexRecord {
+            std::atomic<EdgeBlock *> head{nullptr};
+            // The last block, or one of the blocks before it while a thread is linking the next block.
+            std::atomic<EdgeBlock *> tail{nullptr};
+            std::atomic<std::uint64_t> degree{0};
+        };
+
+        // segments_[k] holds the vertices [kFirstSegmentSize * (2^k - 1), kFirstSegmentSize * (2^(k+1) - 1)).
+        std::array<std::atomic<VertexRecord *>, kSegmentCount> segments_;
+
+        std::atomic<std::uint64_t> vertex_count_{0};
+
+        std::atomic<std::uint64_t> edge_count_{0};
+
+        // Returns the segment index and the offset of the vertex in the segment.
+        static std::pair<std::size_t, std::uint64_t> locate(std::uint64_t vertex_id);
+
+        // Returns the record of the vertex, allocates the segment if it's not allocated yet.
+        VertexRecord &record(std::uint64_t vertex_id);
+
+        // Returns the record of the vertex, or nullptr if its segment is not allocated yet.
+        const VertexRecord *findRecord(std::uint64_t vertex_id) const;
+
+        // Frees the vertex table and the edge blocks.
+        void release();
+
+        // Exchanges the vertex tables and the counters, neither adjacency should be modified concurrently.
+        void swap(ConcurrentAdjacency &other) noexcept;
+    };
+
+    ///
+    /// @brief CompressedCsrAdjacency stores the neighbours of every vertex sorted and gap-encoded in one contiguous
+    /// byte stream, which takes a fraction of the memory of CsrAdjacency on the graphs with locality.
+    ///
+    /// The stream of a vertex starts with its degree as a LEB128 varint, followed by groups of up to 4 gaps in Group
+    /// Varint format: a control byte with 2 bits per gap selecting its length of 1, 2, 4 or 8 bytes, then the gaps in
+    /// little-endian order. The first gap is the zigzag-encoded difference between the first neighbour and the vertex
+    /// itself, the following gaps are the differences between consecutive neighbours. Every gap is decoded with one
+    /// unaligned 8-byte load and a mask, the stream is padded so that the loads never leave the buffer.
+    ///
+    /// Edge insertion re-encodes the neighbours of the origin vertex and shifts the tail of the stream, taking O(V+E)
+    /// time, so the layout is meant for read-mostly graphs that are loaded in bulk. The buffers are shared by the
+    /// copies of the adjacency in the same way as the arrays of CsrAdjacency.
+    ///
+    class CompressedCsrAdjacency {
+    public:
+        /// Creates the empty adjacency
+        CompressedCsrAdjacency();
+
+        ///
+        /// @brief Compresses the adjacency, the neighbours of every vertex are sorted by their IDs.
+        ///
+        /// @param csr The adjacency to compress
+        /// @param thread_pool The threads to compress on, nullptr compresses on the calling thread
+        /// @return The compressed adjacency
+        ///
+        static CompressedCsrAdjacency FromCsr(const CsrAdjacency &csr, ThreadPool *thread_pool = nullptr);
+
+        /// @return The number of vertices stored in the adjacency
+        std::uint64_t VertexCount() const;
+
+        /// @return The number of edges stored in the adjacency
+        std::uint64_t EdgeCount() const;
+
+        /// @return The memory of the buffers, counted by their capacity
+        MemoryFootprint Footprint() const;
+
+        /// @return The number of bytes of the encoded neighbours and their offsets
+        std::uint64_t EncodedBytes() const;
+
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @return The number of outgoing edges of the vertex
+        ///
+        std::uint64_t Degree(std::uint64_t vertex_id) const;
+
+        ///
+        /// @brief Appends a vertex without outgoing edges.
+        /// @return The ID of the appended vertex
+        /// @throws std::length_error if the adjacency already holds kMaxVertexCount vertices
+        ///
+        std::uint64_t AddVertex();
+
+        ///
+        /// @param src_vertex_id The origin vertex ID of the edge, should be valid
+        /// @param dst_vertex_id The destination vertex ID of the edge
+        ///
+        void AddEdge(std::uint64_t src_vertex_id, std::uint64_t dst_vertex_id);
+
+        ///
+        /// @brief Calls visitor for each outgoing neighbour of the vertex in the order of the neighbour IDs, decoding
+        /// the neighbours on the fly.
+        ///
+        /// @param vertex_id The vertex ID to process, should be valid
+        /// @param visitor Callable taking the neighbour ID and returning false to stop the iteration
+        /// @return false if the iteration was stopped by the visitor, otherwise returns true
+        ///
+        template<typename Visitor>
+        bool ForEachNeighbour(std::uint64_t vertex_id, Visitor &&visitor) const {
+            const std::uint8_t *it = data_->data() + (*offsets_)[vertex_id];
+            std::uint64_t remaining = readVarint(it);
+            if (remaining == 0) {
+                return true;
+            }
+
+            // The first gap is relative to the vertex itself, the addition wraps around for the negative ones.
+            std::uint64_t neighbour = vertex_id;
+            bool first = true;
+            while (remaining != 0) {
+                const std::uint8_t control = *it++;
+                const std::uint64_t group_size = std::min<std::uint64_t>(remaining, kGroupSize);
+                for (std::uint64_t i = 0; i < group_size; ++i) {
+                    const unsigned code = (control >> (2 * i)) & 3;
+                    std::uint64_t gap;
+                    std::memcpy(&gap, it, sizeof(gap));
+                    gap &= kGapMasks[code];
+                    it += std::size_t(1) << code;
+
+                    if (first) {
+                        neighbour += (gap >> 1) ^ (~(gap & 1) + 1);
+                        first = false;
+                    } else {
+                        neighbour += gap;
+                    }
+                    if (!visitor(neighbour)) {
+                        return false;
+                    }
+                }
+                remaining -= group_size;
+            }
+            return true;
+        }
+
+    private:
+        // The number of gaps sharing one control byte.
+        static constexpr std::uint64_t kGroupSize = 4;
+
+        // The zero bytes after the stream, so that the 8-byte load of the last gap stays in the buffer.
+        static constexpr std::size_t kPadding = sizeof(std::uint64_t) - 1;
+
+        // The number of vertices a thread compresses at once.
+        static constexpr std::uint64_t kBlockSize = 1 << 12;
+
+        // kGapMasks[code] keeps the 2^code lowest bytes of a little-endian word.
+        static constexpr std::uint64_t kGapMasks[4] = {0xFF, 0xFFFF, 0xFFFFFFFF, ~std::uint64_t(0)};
+
+        // offsets_[v] is the position of the stream of the vertex v in data_, offsets_ has V + 1 elements.
+        std::shared_ptr<std::vector<std::uint64_t>> offsets_;
+
+        // The streams of all vertices followed by kPadding zero bytes.
+        std::shared_ptr<std::vector<std::uint8_t>> data_;
+
+        std::uint64_t edge_count_ = 0;
+
+        // Reads the LEB128 varint at it and advances it past the varint.
+        static std::uint64_t readVarint(const std::uint8_t *&it) {
+            std::uint64_t value = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                const std::uint8_t byte = *it++;
+                value |= std::uint64_t(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+        }
+
+        // Appends the stream of the vertex with the sorted neighbours to the buffer.
+        static void encode(std::uint64_t vertex_id, const VertexIdVector &neighbours, std::vector<std::uint8_t> &buffer);
+
+        // Copies the neighbours of the vertex into the vector, in the order of their IDs.
+        void decode(std::uint64_t vertex_id, VertexIdVector &neighbours) const;
+    };
+
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                  "CompressedCsrAdjacency decodes the gaps with little-endian loads.");
+
+    /// Any of the supported adjacency layouts.
+    using Adjacency = std::variant<AdjacencyList, CsrAdjacency, DeltaCsrAdjacency, ConcurrentAdjacency,
+            CompressedCsrAdjacency>;
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_ADJACENCY_HPP
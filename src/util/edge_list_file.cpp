@@ -0,0 +1,299 @@
+#include "edge_list_file.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace graph_util {
+
+    namespace {
+
+        // The number of chunks per thread, more chunks balance the lines of different lengths.
+        constexpr std::size_t kChunksPerThread = 8;
+
+        // The number of vertices whose neighbours a thread sorts at once.
+        constexpr std::uint64_t kSortBlockSize = 1 << 12;
+
+        bool isBlank(const char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        void skipBlanks(const char *&it, const char *end) {
+            while (it != end && isBlank(*it)) {
+                ++it;
+            }
+        }
+
+        // Returns the beginning of the line after the one containing it.
+        const char *nextLine(const char *it, const char *end) {
+            const auto *newline = static_cast<const char *>(std::memchr(it, '\n', end - it));
+            return newline == nullptr ? end : newline + 1;
+        }
+
+        // Parses the decimal vertex ID at it and advances it past the ID, the ID should fit into the stored width.
+        bool parseVertexId(const char *&it, const char *end, std::uint64_t &vertex_id) {
+            const auto [next, error] = std::from_chars(it, end, vertex_id);
+            if (error != std::errc() || vertex_id >= kMaxVertexCount) {
+                return false;
+            }
+            it = next;
+            return true;
+        }
+
+        // Skips the blanks separating two columns, there should be at least one.
+        bool skipSeparator(const char *&it, const char *end) {
+            if (it == end || !isBlank(*it)) {
+                return false;
+            }
+            skipBlanks(it, end);
+            return true;
+        }
+
+        // Checks that nothing but blanks follows on the line.
+        bool atLineEnd(const char *&it, const char *end) {
+            skipBlanks(it, end);
+            return it == end || *it == '\n';
+        }
+
+        ///
+        /// @brief Calls visitor with the first column and the vertex ID of every data line in [it, end), the empty
+        /// and the comment lines are skipped.
+        ///
+        /// @param parse_column Callable parsing the first column at the passed iterator, returns std::nullopt if it's
+        /// malformed
+        /// @param visitor Callable taking the column and the vertex ID, returns false if the line is not valid
+        /// @return The beginning of the first malformed line, nullptr if there is none
+        ///
+        template<typename ParseColumn, typename Visitor>
+        const char *forEachLine(const char *it, const char *end, ParseColumn &&parse_column, Visitor &&visitor) {
+            while (it != end) {
+                const char *line = it;
+                skipBlanks(it, end);
+                if (it == end) {
+                    break;
+                }
+                if (*it == '\n' || *it == '#' || *it == '%') {
+                    it = nextLine(it, end);
+                    continue;
+                }
+
+                auto column = parse_column(it, end);
+                std::uint64_t vertex_id;
+                if (!column.has_value() || !skipSeparator(it, end) || !parseVertexId(it, end, vertex_id) ||
+                    !atLineEnd(it, end) || !visitor(*column, vertex_id)) {
+                    return line;
+                }
+                it = nextLine(it, end);
+            }
+            return nullptr;
+        }
+
+        // Calls visitor with the source and the destination of every edge in [it, end).
+        template<typename Visitor>
+        const char *forEachEdge(const char *it, const char *end, Visitor &&visitor) {
+            const auto parse_source = [](const char *&column, const char *column_end) {
+                std::uint64_t vertex_id;
+                return parseVertexId(column, column_end, vertex_id) ? std::optional<std::uint64_t>(vertex_id)
+                                                                    : std::nullopt;
+            };
+            return forEachLine(it, end, parse_source, visitor);
+        }
+
+        // Calls visitor with the label and the vertex of every line in [it, end).
+        template<typename Visitor>
+        const char *forEachLabel(const char *it, const char *end, Visitor &&visitor) {
+            const auto parse_label = [](const char *&column, const char *column_end) {
+                const char *begin = column;
+                while (column != column_end && *column != '\n' && !isBlank(*column)) {
+                    ++column;
+                }
+                return std::optional<std::string_view>(std::string_view(begin, column - begin));
+            };
+            return forEachLine(it, end, parse_label, visitor);
+        }
+
+        ///
+        /// @brief Splits the mapped file into chunks of whole lines and runs parse_chunk on all threads of the pool,
+        /// the threads claim the chunks one by one. The threads do not throw, so the malformed lines are reported by
+        /// parse_chunk and thrown here.
+        ///
+        /// @param file The mapped file
+        /// @param path The path of the file, used in the error message
+        /// @param chunk_count The number of chunks, parse_chunk is called exactly once per chunk
+        /// @param parse_chunk Callable taking the chunk index, the thread index, the beginning and the end of the
+        /// chunk, returns the beginning of the first malformed line or nullptr
+        /// @throws std::runtime_error with the number of the first malformed line
+        ///
+        template<typename ParseChunk>
+        void parseChunks(const MappedFile &file, const std::string &path, ThreadPool &thread_pool,
+                         const std::size_t chunk_count, ParseChunk &&parse_chunk) {
+            const auto *data = reinterpret_cast<const char *>(file.Data());
+            const char *end = data + file.Size();
+
+            // Every boundary is moved forward to the beginning of the next line.
+            std::vector<const char *> boundaries(chunk_count + 1, data);
+            for (std::size_t i = 1; i < chunk_count; ++i) {
+                const char *boundary = std::max(data + file.Size() * i / chunk_count, boundaries[i - 1]);
+                if (boundary != data && boundary != end && boundary[-1] != '\n') {
+                    boundary = nextLine(boundary, end);
+                }
+                boundaries[i] = boundary;
+            }
+            boundaries[chunk_count] = end;
+
+            std::vector<const char *> errors(chunk_count, nullptr);
+            std::atomic<std::size_t> next_chunk{0};
+            thread_pool.Run([&](const std::size_t thread_index) {
+                for (std::size_t c = next_chunk++; c < chunk_count; c = next_chunk++) {
+                    errors[c] = parse_chunk(c, thread_index, boundaries[c], boundaries[c + 1]);
+                }
+            });
+
+            for (const char *error: errors) {
+                if (error != nullptr) {
+                    throw std::runtime_error("The file " + path + " is malformed at line " +
+                                             std::to_string(std::count(data, error, '\n') + 1) + ".");
+                }
+            }
+        }
+
+    } // namespace
+
+    EdgeListFile::EdgeListFile(std::string path) : path_(std::move(path)), file_(path_) {
+    }
+
+    std::uint64_t EdgeListFile::VertexCount(ThreadPool &thread_pool) const {
+        std::vector<std::uint64_t> vertex_counts(thread_pool.ThreadCount(), 0);
+        parseChunks(file_, path_, thread_pool, thread_pool.ThreadCount() * kChunksPerThread,
+                    [&vertex_counts](std::size_t, const std::size_t thread_index, const char *begin, const char *end) {
+                        std::uint64_t &vertex_count = vertex_counts[thread_index];
+                        return forEachEdge(begin, end, [&vertex_count](const std::uint64_t src, const std::uint64_t dst) {
+                            vertex_count = std::max(vertex_count, std::max(src, dst) + 1);
+                            return true;
+                        });
+                    });
+        return *std::max_element(vertex_counts.begin(), vertex_counts.end());
+    }
+
+    void EdgeListFile::BuildCsr(const std::uint64_t vertex_count, ThreadPool &thread_pool, CsrAdjacency &out_edges,
+                                CsrAdjacency *const in_edges) const {
+        const std::size_t chunk_count = thread_pool.ThreadCount() * kChunksPerThread;
+
+        // cursors[v] counts the degree of the vertex v, and after the prefix sum it's the next free slot of v.
+        // Value-initialized, so the counters start at 0.
+        std::vector<std::atomic<std::uint64_t>> out_cursors(vertex_count);
+        std::vector<std::atomic<std::uint64_t>> in_cursors(in_edges != nullptr ? vertex_count : 0);
+
+        parseChunks(file_, path_, thread_pool, chunk_count,
+                    [&](std::size_t, std::size_t, const char *begin, const char *end) {
+                        return forEachEdge(begin, end, [&](const std::uint64_t src, const std::uint64_t dst) {
+                            if (src >= vertex_count || dst >= vertex_count) {
+                                return false;
+                            }
+                            out_cursors[src].fetch_add(1, std::memory_order_relaxed);
+                            if (in_edges != nullptr) {
+                                in_cursors[dst].fetch_add(1, std::memory_order_relaxed);
+                            }
+                            return true;
+                        });
+                    });
+
+        // Turns the degrees into the offsets, and the counters into the first slots of the vertices.
+        const auto prefix_sum = [vertex_count](std::vector<std::atomic<std::uint64_t>> &cursors) {
+            std::vector<std::uint64_t> offsets(vertex_count + 1);
+            offsets[0] = 0;
+            for (std::uint64_t v = 0; v < vertex_count; ++v) {
+                offsets[v + 1] = offsets[v] + cursors[v].load(std::memory_order_relaxed);
+                cursors[v].store(offsets[v], std::memory_order_relaxed);
+            }
+            return offsets;
+        };
+        std::vector<std::uint64_t> out_offsets = prefix_sum(out_cursors);
+        std::vector<std::uint64_t> in_offsets = in_edges != nullptr ? prefix_sum(in_cursors)
+                                                                    : std::vector<std::uint64_t>();
+
+        VertexIdVector out_targets(out_offsets.back());
+        VertexIdVector in_targets(in_edges != nullptr ? in_offsets.back() : 0);
+        parseChunks(file_, path_, thread_pool, chunk_count,
+                    [&](std::size_t, std::size_t, const char *begin, const char *end) {
+                        // The vertex IDs were checked by the counting pass.
+                        return forEachEdge(begin, end, [&](const std::uint64_t src, const std::uint64_t dst) {
+                            out_targets[out_cursors[src].fetch_add(1, std::memory_order_relaxed)] = VertexId(dst);
+                            if (in_edges != nullptr) {
+                                in_targets[in_cursors[dst].fetch_add(1, std::memory_order_relaxed)] = VertexId(src);
+                            }
+                            return true;
+                        });
+                    });
+        out_cursors = std::vector<std::atomic<std::uint64_t>>();
+        in_cursors = std::vector<std::atomic<std::uint64_t>>();
+
+        // Sort the neighbours of every vertex, the threads claim the blocks of vertices one by one.
+        const auto sort_neighbours = [&thread_pool, vertex_count](const std::vector<std::uint64_t> &offsets,
+                                                                 VertexIdVector &targets) {
+            std::atomic<std::uint64_t> next_block{0};
+            thread_pool.Run([&](std::size_t) {
+                for (std::uint64_t first = next_block.fetch_add(kSortBlockSize); first < vertex_count;
+                     first = next_block.fetch_add(kSortBlockSize)) {
+                    const std::uint64_t last = std::min(first + kSortBlockSize, vertex_count);
+                    for (std::uint64_t v = first; v < last; ++v) {
+                        std::sort(targets.begin() + offsets[v], targets.begin() + offsets[v + 1]);
+                    }
+                }
+            });
+        };
+        sort_neighbours(out_offsets, out_targets);
+        out_edges = CsrAdjacency(std::move(out_offsets), std::move(out_targets));
+        if (in_edges != nullptr) {
+            sort_neighbours(in_offsets, in_targets);
+            *in_edges = CsrAdjacency(std::move(in_offsets), std::move(in_targets));
+        }
+    }
+
+    LabelFile::LabelFile(std::string path) : path_(std::move(path)), file_(path_) {
+    }
+
+    LabelFile::Contents LabelFile::Read(ThreadPool &thread_pool) const {
+        const std::size_t chunk_count = thread_pool.ThreadCount() * kChunksPerThread;
+
+        // Every chunk collects its labels in the order of their first line.
+        std::vector<Contents> chunks(chunk_count);
+        parseChunks(file_, path_, thread_pool, chunk_count,
+                    [&chunks](const std::size_t chunk_index, std::size_t, const char *begin, const char *end) {
+                        Contents &chunk = chunks[chunk_index];
+                        std::unordered_map<std::string_view, std::size_t> indices;
+                        return forEachLabel(begin, end, [&](const std::string_view label,
+                                                            const std::uint64_t vertex_id) {
+                            const auto [it, inserted] = indices.emplace(label, chunk.labels.size());
+                            if (inserted) {
+                                chunk.labels.push_back({label, {}});
+                            }
+                            chunk.labels[it->second].vertices.push_back(vertex_id);
+                            chunk.vertex_count = std::max(chunk.vertex_count, vertex_id + 1);
+                            return true;
+                        });
+                    });
+
+        // Merge the chunks in the file order, so that the order does not depend on the thread count.
+        Contents contents;
+        std::unordered_map<std::string_view, std::size_t> indices;
+        for (auto &chunk: chunks) {
+            contents.vertex_count = std::max(contents.vertex_count, chunk.vertex_count);
+            for (auto &label_vertices: chunk.labels) {
+                const auto [it, inserted] = indices.emplace(label_vertices.label, contents.labels.size());
+                if (inserted) {
+                    contents.labels.push_back(std::move(label_vertices));
+                } else {
+                    auto &vertices = contents.labels[it->second].vertices;
+                    vertices.insert(vertices.end(), label_vertices.vertices.begin(), label_vertices.vertices.end());
+                }
+            }
+            chunk = Contents();
+        }
+        return contents;
+    }
+
+} // namespace graph_util
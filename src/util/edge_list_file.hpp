@@ -0,0 +1,102 @@
+#ifndef GRAPHSTORE_EDGE_LIST_FILE_HPP
+#define GRAPHSTORE_EDGE_LIST_FILE_HPP
+
+#include "graph_util.hpp"
+#include "adjacency.hpp"
+#include "snapshot_file.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace graph_util {
+
+    ///
+    /// @brief EdgeListFile reads a text edge list with one "src dst" pair of decimal vertex IDs per line. The columns
+    /// are separated by spaces or tabs, the empty lines and the comment lines starting with '#' or '%' are skipped.
+    ///
+    /// The file is memory-mapped and split into chunks of whole lines that are parsed on all threads of the pool. The
+    /// edges are never collected: the file is parsed once to find the vertex count, once to count the degrees and
+    /// once to scatter the edges into the CSR arrays, so the memory stays bounded by the size of the built adjacency.
+    ///
+    class EdgeListFile {
+    public:
+        ///
+        /// @param path The path of the edge list
+        /// @throws std::runtime_error if the file can not be opened or mapped
+        ///
+        explicit EdgeListFile(std::string path);
+
+        ///
+        /// @param thread_pool The threads to parse on
+        /// @return The largest vertex ID in the file plus one, 0 for the file without edges
+        /// @throws std::runtime_error if the file has a malformed line
+        ///
+        std::uint64_t VertexCount(ThreadPool &thread_pool) const;
+
+        ///
+        /// @brief Builds the CSR adjacency of the edges. The parallel scatter does not keep the order of the lines, so
+        /// the neighbours of every vertex are sorted by their IDs instead, which makes the result independent of the
+        /// thread count.
+        ///
+        /// @param vertex_count The number of vertices in the graph, at least VertexCount()
+        /// @param thread_pool The threads to parse and build on
+        /// @param out_edges The adjacency of the edges
+        /// @param in_edges The adjacency of the reversed edges, built in the same passes, nullptr skips it
+        /// @throws std::runtime_error if the file has a malformed line or a vertex ID not less than vertex_count
+        ///
+        void BuildCsr(std::uint64_t vertex_count, ThreadPool &thread_pool, CsrAdjacency &out_edges,
+                      CsrAdjacency *in_edges) const;
+
+    private:
+        std::string path_;
+        MappedFile file_;
+    };
+
+    ///
+    /// @brief LabelFile reads a text label file with one "label vertex" pair per line, the label is the first column
+    /// and can not contain spaces or tabs. The empty lines and the comment lines starting with '#' or '%' are skipped.
+    ///
+    /// The file is memory-mapped and split into chunks of whole lines that are parsed on all threads of the pool, the
+    /// labels are read in place from the mapping.
+    ///
+    class LabelFile {
+    public:
+        /// The vertices of one label of the file
+        struct LabelVertices {
+            /// The label, pointing into the mapped file
+            std::string_view label;
+            /// The vertices in the order of their lines
+            VertexVector vertices;
+        };
+
+        /// The parsed contents of the file
+        struct Contents {
+            /// The labels in the order of their first line
+            std::vector<LabelVertices> labels;
+            /// The largest vertex ID in the file plus one, 0 for the file without labels
+            std::uint64_t vertex_count = 0;
+        };
+
+        ///
+        /// @param path The path of the label file
+        /// @throws std::runtime_error if the file can not be opened or mapped
+        ///
+        explicit LabelFile(std::string path);
+
+        ///
+        /// @param thread_pool The threads to parse on
+        /// @return The contents of the file, the labels stay valid as long as this object
+        /// @throws std::runtime_error if the file has a malformed line
+        ///
+        Contents Read(ThreadPool &thread_pool) const;
+
+    private:
+        std::string path_;
+        MappedFile file_;
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_EDGE_LIST_FILE_HPP
@@ -0,0 +1,263 @@
+#include "graph_generator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace graph_util {
+
+    namespace {
+
+        // Draws the integers and the reals from std::mt19937_64 in the same way on every platform.
+        class Random {
+        public:
+            explicit Random(const std::uint64_t seed) : engine_(seed) {
+            }
+
+            // Returns the integer in [0, bound), bound should be positive. The modulo bias is negligible for the
+            // bounds of the generated graphs.
+            std::uint64_t Below(const std::uint64_t bound) {
+                return engine_() % bound;
+            }
+
+            // Returns the real in [0, 1) with 53 random bits.
+            double Unit() {
+                return double(engine_() >> 11) * 0x1.0p-53;
+            }
+
+        private:
+            std::mt19937_64 engine_;
+        };
+
+        // Returns the index of the weight the point falls into, cumulative holds the running sums of the weights.
+        std::size_t pickWeighted(const std::vector<double> &cumulative, Random &random) {
+            const double point = random.Unit() * cumulative.back();
+            const auto it = std::upper_bound(cumulative.begin(), cumulative.end(), point);
+            return std::min<std::size_t>(it - cumulative.begin(), cumulative.size() - 1);
+        }
+
+        // Collects the vertices of every label, leaving out the labels without vertices.
+        std::unordered_map<Label, VertexSet> labelMap(const std::vector<VertexVector> &label_vertices) {
+            std::unordered_map<Label, VertexSet> result;
+            for (std::uint64_t label = 0; label < label_vertices.size(); ++label) {
+                if (!label_vertices[label].empty()) {
+                    result.emplace(GeneratedLabel(label),
+                                   VertexSet(label_vertices[label].begin(), label_vertices[label].end()));
+                }
+            }
+            return result;
+        }
+
+        // Every vertex draws labels_per_vertex labels with the probabilities proportional to the weights.
+        std::unordered_map<Label, VertexSet> drawLabels(const std::uint64_t vertex_count,
+                                                        const std::vector<double> &weights,
+                                                        const std::uint64_t labels_per_vertex,
+                                                        const std::uint64_t seed) {
+            if (weights.empty()) {
+                return {};
+            }
+            std::vector<double> cumulative(weights.size());
+            std::partial_sum(weights.begin(), weights.end(), cumulative.begin());
+
+            Random random(seed);
+            std::vector<VertexVector> label_vertices(weights.size());
+            for (std::uint64_t v = 0; v < vertex_count; ++v) {
+                for (std::uint64_t i = 0; i < labels_per_vertex; ++i) {
+                    label_vertices[pickWeighted(cumulative, random)].push_back(v);
+                }
+            }
+            return labelMap(label_vertices);
+        }
+
+    } // namespace
+
+    std::vector<Edge> GenerateKroneckerGraph(const std::vector<std::vector<double>> &initiator,
+                                             const std::uint64_t levels, const std::uint64_t edge_count,
+                                             const std::uint64_t seed) {
+        const std::uint64_t side = initiator.size();
+        if (side < 2) {
+            throw std::invalid_argument("The Kronecker initiator should be at least 2x2.");
+        }
+        std::vector<double> cumulative;
+        for (const auto &row: initiator) {
+            if (row.size() != side) {
+                throw std::invalid_argument("The Kronecker initiator should be a square matrix.");
+            }
+            for (const double weight: row) {
+                if (!(weight >= 0)) {
+                    throw std::invalid_argument("The Kronecker initiator weights should be non-negative.");
+                }
+                cumulative.push_back((cumulative.empty() ? 0 : cumulative.back()) + weight);
+            }
+        }
+        if (!(cumulative.back() > 0)) {
+            throw std::invalid_argument("The Kronecker initiator weights should have a positive sum.");
+        }
+
+        std::uint64_t vertex_count = 1;
+        for (std::uint64_t level = 0; level < levels; ++level) {
+            if (vertex_count > kMaxVertexCount / side) {
+                throw std::invalid_argument("The Kronecker graph has more than kMaxVertexCount vertices.");
+            }
+            vertex_count *= side;
+        }
+
+        Random random(seed);
+        std::vector<Edge> edges(edge_count);
+        for (auto &edge: edges) {
+            std::uint64_t src = 0;
+            std::uint64_t dst = 0;
+            for (std::uint64_t level = 0; level < levels; ++level) {
+                const std::size_t cell = pickWeighted(cumulative, random);
+                src = src * side + cell / side;
+                dst = dst * side + cell % side;
+            }
+            edge = {src, dst};
+        }
+
+        // Without the shuffle the vertex 0 would have the highest degree and the degrees would fall with the IDs.
+        VertexVector permutation(vertex_count);
+        for (std::uint64_t v = 0; v < vertex_count; ++v) {
+            permutation[v] = v;
+        }
+        for (std::uint64_t v = vertex_count; v > 1; --v) {
+            std::swap(permutation[v - 1], permutation[random.Below(v)]);
+        }
+        for (auto &edge: edges) {
+            edge = {permutation[edge.source_vertex], permutation[edge.destination_vertex]};
+        }
+        return edges;
+    }
+
+    std::vector<Edge> GenerateRmatGraph(const std::uint64_t scale, const std::uint64_t edge_count,
+                                        const RmatProbabilities &probabilities, const std::uint64_t seed) {
+        return GenerateKroneckerGraph({{probabilities.a, probabilities.b}, {probabilities.c, probabilities.d}}, scale,
+                                      edge_count, seed);
+    }
+
+    std::vector<Edge> GenerateErdosRenyiGraph(const std::uint64_t vertex_count, const std::uint64_t edge_count,
+                                              const std::uint64_t seed) {
+        if (vertex_count == 0 && edge_count > 0) {
+            throw std::invalid_argument("The graph without vertices can not have edges.");
+        }
+        Random random(seed);
+        std::vector<Edge> edges(edge_count);
+        for (auto &edge: edges) {
+            edge.source_vertex = random.Below(vertex_count);
+            edge.destination_vertex = random.Below(vertex_count);
+        }
+        return edges;
+    }
+
+    std::vector<Edge> GenerateGridGraph(const std::uint64_t rows, const std::uint64_t columns) {
+        std::vector<Edge> edges;
+        for (std::uint64_t r = 0; r < rows; ++r) {
+            for (std::uint64_t c = 0; c < columns; ++c) {
+                const std::uint64_t v = r * columns + c;
+                if (c + 1 < columns) {
+                    edges.push_back({v, v + 1});
+                    edges.push_back({v + 1, v});
+                }
+                if (r + 1 < rows) {
+                    edges.push_back({v, v + columns});
+                    edges.push_back({v + columns, v});
+                }
+            }
+        }
+        return edges;
+    }
+
+    std::vector<Edge> GenerateChainGraph(const std::uint64_t vertex_count, const bool both_directions) {
+        std::vector<Edge> edges;
+        for (std::uint64_t v = 0; v + 1 < vertex_count; ++v) {
+            edges.push_back({v, v + 1});
+            if (both_directions) {
+                edges.push_back({v + 1, v});
+            }
+        }
+        return edges;
+    }
+
+    std::vector<Edge> GenerateStarGraph(const std::uint64_t vertex_count) {
+        std::vector<Edge> edges;
+        for (std::uint64_t v = 1; v < vertex_count; ++v) {
+            edges.push_back({0, v});
+            edges.push_back({v, 0});
+        }
+        return edges;
+    }
+
+    Label GeneratedLabel(const std::uint64_t label_index) {
+        return "label" + std::to_string(label_index);
+    }
+
+    std::unordered_map<Label, VertexSet> GenerateUniformLabels(const std::uint64_t vertex_count,
+                                                               const std::uint64_t label_count,
+                                                               const std::uint64_t labels_per_vertex,
+                                                               const std::uint64_t seed) {
+        return drawLabels(vertex_count, std::vector<double>(label_count, 1), labels_per_vertex, seed);
+    }
+
+    std::unordered_map<Label, VertexSet> GenerateZipfianLabels(const std::uint64_t vertex_count,
+                                                               const std::uint64_t label_count,
+                                                               const std::uint64_t labels_per_vertex,
+                                                               const double exponent, const std::uint64_t seed) {
+        std::vector<double> weights(label_count);
+        for (std::uint64_t i = 0; i < label_count; ++i) {
+            weights[i] = 1 / std::pow(double(i + 1), exponent);
+        }
+        return drawLabels(vertex_count, weights, labels_per_vertex, seed);
+    }
+
+    std::unordered_map<Label, VertexSet> GenerateCommunityLabels(const std::uint64_t vertex_count,
+                                                                 const std::vector<Edge> &edges,
+                                                                 const std::uint64_t label_count, const double noise,
+                                                                 const std::uint64_t seed) {
+        if (label_count == 0 || vertex_count == 0) {
+            return {};
+        }
+
+        // The undirected neighbours, the communities grow against the edge directions as well.
+        std::vector<VertexVector> neighbours(vertex_count);
+        for (const auto &edge: edges) {
+            neighbours[edge.source_vertex].push_back(edge.destination_vertex);
+            neighbours[edge.destination_vertex].push_back(edge.source_vertex);
+        }
+
+        Random random(seed);
+        constexpr std::uint64_t kNoLabel = std::numeric_limits<std::uint64_t>::max();
+        VertexVector vertex_label(vertex_count, kNoLabel);
+        std::deque<std::uint64_t> queue;
+        for (std::uint64_t label = 0; label < label_count; ++label) {
+            const std::uint64_t v = random.Below(vertex_count);
+            if (vertex_label[v] == kNoLabel) {
+                vertex_label[v] = label;
+                queue.push_back(v);
+            }
+        }
+        while (!queue.empty()) {
+            const std::uint64_t v = queue.front();
+            queue.pop_front();
+            for (const std::uint64_t neighbour: neighbours[v]) {
+                if (vertex_label[neighbour] == kNoLabel) {
+                    vertex_label[neighbour] = vertex_label[v];
+                    queue.push_back(neighbour);
+                }
+            }
+        }
+
+        std::vector<VertexVector> label_vertices(label_count);
+        for (std::uint64_t v = 0; v < vertex_count; ++v) {
+            if (vertex_label[v] == kNoLabel || random.Unit() < noise) {
+                vertex_label[v] = random.Below(label_count);
+            }
+            label_vertices[vertex_label[v]].push_back(v);
+        }
+        return labelMap(label_vertices);
+    }
+
+} // namespace graph_util
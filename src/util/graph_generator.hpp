@@ -0,0 +1,159 @@
+#ifndef GRAPHSTORE_GRAPH_GENERATOR_HPP
+#define GRAPHSTORE_GRAPH_GENERATOR_HPP
+
+#include "graph_util.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace graph_util {
+
+    //
+    // Synthetic graphs and labels for the tests and the benchmarks. The random generators take a seed and produce the
+    // same output for the same arguments on every platform: they draw from std::mt19937_64, which is fully specified
+    // by the standard, and do not use the implementation-defined standard distributions.
+    //
+
+    ///
+    /// @brief The probabilities of the quadrants of the adjacency matrix an R-MAT edge recursively falls into, the
+    /// defaults are the ones of the Graph500 benchmark.
+    ///
+    struct RmatProbabilities {
+        /// The top left quadrant, the edges between the low vertex IDs
+        double a = 0.57;
+        /// The top right quadrant
+        double b = 0.19;
+        /// The bottom left quadrant
+        double c = 0.19;
+        /// The bottom right quadrant, the edges between the high vertex IDs
+        double d = 0.05;
+    };
+
+    ///
+    /// @brief Generates a stochastic Kronecker graph with initiator.size()^levels vertices. Every edge picks one cell
+    /// of the initiator per level with the probability proportional to its weight, the cells select the digits of the
+    /// endpoint IDs. The vertex IDs are shuffled afterwards, so that the high degree vertices are spread over the ID
+    /// range.
+    ///
+    /// @param initiator The square matrix of the non-negative cell weights, at least 2x2
+    /// @param levels The number of the Kronecker products, the power of the vertex count
+    /// @param edge_count The number of the generated edges, the duplicates and the self loops are kept
+    /// @param seed The seed of the random generator
+    /// @return The generated edges
+    /// @throws std::invalid_argument if the initiator is not a square matrix of the non-negative weights with a
+    /// positive sum, or if the vertex count exceeds kMaxVertexCount
+    ///
+    std::vector<Edge> GenerateKroneckerGraph(const std::vector<std::vector<double>> &initiator, std::uint64_t levels,
+                                             std::uint64_t edge_count, std::uint64_t seed);
+
+    ///
+    /// @brief Generates an R-MAT graph with 2^scale vertices, the Kronecker graph with the 2x2 initiator of the
+    /// quadrant probabilities. The degrees follow a power law, a few vertices have most of the edges.
+    ///
+    /// @param scale The base two logarithm of the vertex count
+    /// @param edge_count The number of the generated edges, the duplicates and the self loops are kept
+    /// @param probabilities The probabilities of the quadrants
+    /// @param seed The seed of the random generator
+    /// @return The generated edges
+    /// @throws std::invalid_argument if a probability is negative or all of them are zero, or if the vertex count
+    /// exceeds kMaxVertexCount
+    ///
+    std::vector<Edge> GenerateRmatGraph(std::uint64_t scale, std::uint64_t edge_count,
+                                        const RmatProbabilities &probabilities, std::uint64_t seed);
+
+    ///
+    /// @brief Generates an Erdős–Rényi G(n, m) graph: every edge connects two uniformly random vertices.
+    ///
+    /// @param vertex_count The number of vertices in the graph
+    /// @param edge_count The number of the generated edges, the duplicates and the self loops are kept
+    /// @param seed The seed of the random generator
+    /// @return The generated edges
+    /// @throws std::invalid_argument if edge_count is positive for the graph without vertices
+    ///
+    std::vector<Edge> GenerateErdosRenyiGraph(std::uint64_t vertex_count, std::uint64_t edge_count, std::uint64_t seed);
+
+    ///
+    /// @brief Generates a 2D grid, the vertex in the row r and the column c has the ID r * columns + c and is connected
+    /// in both directions to its right and bottom neighbours. The diameter is rows + columns - 2.
+    ///
+    /// @param rows The number of rows
+    /// @param columns The number of columns
+    /// @return The generated edges
+    ///
+    std::vector<Edge> GenerateGridGraph(std::uint64_t rows, std::uint64_t columns);
+
+    ///
+    /// @brief Generates a chain through the vertices in the order of their IDs, the graph with the largest diameter.
+    ///
+    /// @param vertex_count The number of vertices in the graph
+    /// @param both_directions Connect the consecutive vertices in both directions instead of the increasing one
+    /// @return The generated edges
+    ///
+    std::vector<Edge> GenerateChainGraph(std::uint64_t vertex_count, bool both_directions);
+
+    ///
+    /// @brief Generates a star, the vertex 0 is connected in both directions to all other vertices. The center has
+    /// the degree of the whole graph.
+    ///
+    /// @param vertex_count The number of vertices in the graph
+    /// @return The generated edges
+    ///
+    std::vector<Edge> GenerateStarGraph(std::uint64_t vertex_count);
+
+    ///
+    /// @param label_index The index of the generated label
+    /// @return The name of the generated label with the index, "label" followed by the index
+    ///
+    Label GeneratedLabel(std::uint64_t label_index);
+
+    ///
+    /// @brief Every vertex draws labels_per_vertex labels uniformly from label_count ones. The draws are with
+    /// replacement, so a vertex may end up with less distinct labels.
+    ///
+    /// @param vertex_count The number of vertices in the graph
+    /// @param label_count The number of labels, named by GeneratedLabel
+    /// @param labels_per_vertex The number of draws per vertex
+    /// @param seed The seed of the random generator
+    /// @return The map from a label to the vertices with the label, the labels without vertices are left out
+    ///
+    std::unordered_map<Label, VertexSet> GenerateUniformLabels(std::uint64_t vertex_count, std::uint64_t label_count,
+                                                               std::uint64_t labels_per_vertex, std::uint64_t seed);
+
+    ///
+    /// @brief Every vertex draws labels_per_vertex labels from label_count ones with the Zipfian distribution: the
+    /// label i is drawn with the probability proportional to 1 / (i + 1)^exponent, so a few labels are common and most
+    /// of them are rare. The draws are with replacement.
+    ///
+    /// @param vertex_count The number of vertices in the graph
+    /// @param label_count The number of labels, named by GeneratedLabel
+    /// @param labels_per_vertex The number of draws per vertex
+    /// @param exponent The skew of the distribution, 0 is uniform
+    /// @param seed The seed of the random generator
+    /// @return The map from a label to the vertices with the label, the labels without vertices are left out
+    ///
+    std::unordered_map<Label, VertexSet> GenerateZipfianLabels(std::uint64_t vertex_count, std::uint64_t label_count,
+                                                               std::uint64_t labels_per_vertex, double exponent,
+                                                               std::uint64_t seed);
+
+    ///
+    /// @brief Assigns one label per vertex following the structure of the graph: label_count random seed vertices
+    /// grow their communities by a simultaneous Breadth First Search over the edges in both directions, and every
+    /// vertex takes the label of the community that reaches it first. The vertices no seed reaches take a random
+    /// label. Afterwards every vertex takes a random label with the probability noise, so that the communities are
+    /// not perfectly separated.
+    ///
+    /// @param vertex_count The number of vertices in the graph
+    /// @param edges The edges of the graph, all endpoints should be less than vertex_count
+    /// @param label_count The number of labels, named by GeneratedLabel
+    /// @param noise The probability of the random label, from 0 to 1
+    /// @param seed The seed of the random generator
+    /// @return The map from a label to the vertices with the label, the labels without vertices are left out
+    ///
+    std::unordered_map<Label, VertexSet> GenerateCommunityLabels(std::uint64_t vertex_count,
+                                                                 const std::vector<Edge> &edges,
+                                                                 std::uint64_t label_count, double noise,
+                                                                 std::uint64_t seed);
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_GRAPH_GENERATOR_HPP
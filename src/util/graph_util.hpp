@@ -2,6 +2,7 @@
 #define GRAPHSTORE_GRAPH_UTIL_HPP
 
 #include <cstdint>
+#include <limits>
 #include <vector>
 #include <optional>
 #include <unordered_set>
@@ -14,6 +15,35 @@ namespace graph_util {
     using VertexSet = std::unordered_set<std::uint64_t>;
     using VertexVector = std::vector<std::uint64_t>;
 
+    ///
+    /// @brief The type of the vertex IDs stored in the adjacencies and the search states. The API takes and returns
+    /// std::uint64_t IDs, but the library built with GRAPHSTORE_32BIT_VERTEX_IDS stores them in 32 bits: the edges take
+    /// half the memory and a cache line holds twice as many neighbours. A Graph Store then holds at most
+    /// kMaxVertexCount vertices.
+    ///
+#ifdef GRAPHSTORE_32BIT_VERTEX_IDS
+    using VertexId = std::uint32_t;
+#else
+    using VertexId = std::uint64_t;
+#endif
+
+    /// The stored vertex ID that is reserved for the missing vertex or distance
+    constexpr VertexId kNoVertex = std::numeric_limits<VertexId>::max();
+
+    /// The largest number of vertices, every vertex ID is less than kNoVertex
+    constexpr std::uint64_t kMaxVertexCount = kNoVertex;
+
+    /// The vertex IDs in the stored width
+    using VertexIdVector = std::vector<VertexId>;
+
+    ///
+    /// @param value The stored vertex ID or distance
+    /// @return The value widened to 64 bits, kNoVertex is widened to std::numeric_limits<std::uint64_t>::max()
+    ///
+    inline std::uint64_t WidenVertexId(const VertexId value) {
+        return value == kNoVertex ? std::numeric_limits<std::uint64_t>::max() : value;
+    }
+
     ///
     /// @brief Directed Graph edge
     ///
@@ -39,16 +69,6 @@ namespace graph_util {
         }
     };
 
-    ///
-    /// @brief LabelledGraph is a directed unweighted graph where each vertex has set of string labels associated to it.
-    ///
-    struct LabelledGraph {
-        /// Adjacency list structure to store the edges. i-th element of neighbours vector is the adjacency list for vertex i.
-        std::vector<VertexVector> neighbours;
-        /// The hash map from a label to the hash set of vertices that have this label set
-        std::unordered_map<Label, VertexSet> label_to_vertices;
-    };
-
 } // namespace graph_util
 
 #endif //GRAPHSTORE_GRAPH_UTIL_HPP
@@ -0,0 +1,68 @@
+#include "label_dictionary.hpp"
+#include <stdexcept>
+
+namespace graph_util {
+
+    LabelDictionary::LabelDictionary(const LabelDictionary &other) : ids_(other.ids_), labels_(other.labels_.size()) {
+        for (const auto &[label, id]: ids_) {
+            labels_[id] = &label;
+        }
+    }
+
+    LabelDictionary &LabelDictionary::operator=(LabelDictionary other) noexcept {
+        ids_.swap(other.ids_);
+        labels_.swap(other.labels_);
+        return *this;
+    }
+
+    LabelId LabelDictionary::Intern(const Label &label) {
+        const auto it = ids_.find(label);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+
+        if (labels_.size() >= kMaxLabelCount) {
+            throw std::length_error("Too many distinct labels.");
+        }
+
+        const auto id = LabelId(labels_.size());
+        const auto inserted = ids_.emplace(label, id).first;
+        labels_.push_back(&inserted->first);
+        return id;
+    }
+
+    std::optional<LabelId> LabelDictionary::Find(const Label &label) const {
+        const auto it = ids_.find(label);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+
+        return std::nullopt;
+    }
+
+    const Label &LabelDictionary::GetLabel(const LabelId label_id) const {
+        return *labels_[label_id];
+    }
+
+    bool LabelDictionary::Contains(const LabelId label_id) const {
+        return label_id < labels_.size();
+    }
+
+    std::uint64_t LabelDictionary::Size() const {
+        return labels_.size();
+    }
+
+    MemoryFootprint LabelDictionary::Footprint() const {
+        MemoryFootprint footprint = HashMapFootprint(ids_);
+        footprint.AddBuffer<const Label *>(labels_.size(), labels_.capacity());
+        // The short labels are stored inside the string object, which is a part of the hash map node.
+        const std::uint64_t inline_capacity = Label().capacity();
+        for (const auto *label: labels_) {
+            if (label->capacity() > inline_capacity) {
+                footprint.AddBuffer<char>(label->size() + 1, label->capacity() + 1);
+            }
+        }
+        return footprint;
+    }
+
+} // namespace graph_util
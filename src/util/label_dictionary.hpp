@@ -0,0 +1,80 @@
+#ifndef GRAPHSTORE_LABEL_DICTIONARY_HPP
+#define GRAPHSTORE_LABEL_DICTIONARY_HPP
+
+#include "graph_util.hpp"
+#include "memory_usage.hpp"
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace graph_util {
+
+    /// Dense integer ID of the interned label.
+    using LabelId = std::uint32_t;
+
+    ///
+    /// @brief LabelDictionary interns the labels: each distinct label gets a dense 32-bit ID, assigned in the order
+    /// of the first occurrence. The label string is hashed only when it is resolved, all the other operations can use
+    /// the ID.
+    ///
+    class LabelDictionary {
+    public:
+        /// The largest number of labels the dictionary can hold.
+        static constexpr std::uint64_t kMaxLabelCount = std::numeric_limits<LabelId>::max();
+
+        /// Creates the empty dictionary
+        LabelDictionary() = default;
+
+        /// Copies the dictionary, the label pointers are rebuilt to point into the copied hash map
+        LabelDictionary(const LabelDictionary &other);
+
+        LabelDictionary(LabelDictionary &&other) noexcept = default;
+
+        LabelDictionary &operator=(LabelDictionary other) noexcept;
+
+        ///
+        /// @brief Returns the ID of the label, assigns a new ID if the label is not interned yet.
+        /// @param label The label to process
+        /// @return The ID of the label
+        /// @throws std::length_error if the dictionary already holds kMaxLabelCount labels
+        ///
+        LabelId Intern(const Label &label);
+
+        ///
+        /// @param label The label to process
+        /// @return The ID of the label if it's interned
+        /// @return std::nullopt if the label is not interned
+        ///
+        std::optional<LabelId> Find(const Label &label) const;
+
+        ///
+        /// @param label_id The label ID to process, should be valid
+        /// @return The label with the passed ID
+        ///
+        const Label &GetLabel(LabelId label_id) const;
+
+        ///
+        /// @param label_id The label ID to check
+        /// @return true if the label ID was assigned by the dictionary, returns false otherwise
+        ///
+        bool Contains(LabelId label_id) const;
+
+        /// @return The number of interned labels
+        std::uint64_t Size() const;
+
+        /// @return The memory of the hash map, counted by its allocator, of the label strings and of the ID index
+        MemoryFootprint Footprint() const;
+
+    private:
+        // The hash map from the label to its ID.
+        CountedHashMap<Label, LabelId> ids_;
+
+        // labels_[id] points to the key of ids_ for the label with the ID id, keys of unordered_map are never moved.
+        std::vector<const Label *> labels_;
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_LABEL_DICTIONARY_HPP
@@ -0,0 +1,179 @@
+#include "label_index.hpp"
+
+namespace graph_util {
+
+    DenseBitmap::DenseBitmap(const std::uint64_t universe) : words_((universe + 63) / 64, 0) {
+    }
+
+    bool DenseBitmap::Insert(const std::uint64_t vertex_id) {
+        const std::uint64_t word = vertex_id >> 6;
+        if (word >= words_.size()) {
+            words_.resize(word + 1, 0);
+        }
+
+        const std::uint64_t bit = std::uint64_t(1) << (vertex_id & 63);
+        if ((words_[word] & bit) != 0) {
+            return false;
+        }
+        words_[word] |= bit;
+        ++size_;
+        return true;
+    }
+
+    bool DenseBitmap::Erase(const std::uint64_t vertex_id) {
+        if (!Contains(vertex_id)) {
+            return false;
+        }
+        words_[vertex_id >> 6] &= ~(std::uint64_t(1) << (vertex_id & 63));
+        --size_;
+        return true;
+    }
+
+    std::uint64_t DenseBitmap::Size() const {
+        return size_;
+    }
+
+    MemoryFootprint DenseBitmap::Footprint() const {
+        return MemoryFootprint().AddBuffer<std::uint64_t>(words_.size(), words_.capacity());
+    }
+
+    void DenseBitmap::Clear() {
+        std::fill(words_.begin(), words_.end(), 0);
+        size_ = 0;
+    }
+
+    bool CompressedBitmap::Insert(const std::uint64_t vertex_id) {
+        const std::uint64_t key = vertex_id >> 16;
+        const auto low = std::uint16_t(vertex_id & 0xFFFF);
+
+        auto key_it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        const auto index = key_it - keys_.begin();
+        if (key_it == keys_.end() || *key_it != key) {
+            keys_.insert(key_it, key);
+            containers_.insert(containers_.begin() + index, Container());
+        }
+
+        auto &container = containers_[index];
+        if (!container.bits.empty()) {
+            const std::uint64_t bit = std::uint64_t(1) << (low & 63);
+            if ((container.bits[low >> 6] & bit) != 0) {
+                return false;
+            }
+            container.bits[low >> 6] |= bit;
+        } else {
+            const auto it = std::lower_bound(container.array.begin(), container.array.end(), low);
+            if (it != container.array.end() && *it == low) {
+                return false;
+            }
+            container.array.insert(it, low);
+
+            // Convert the container to the bitmap once the array outgrows it.
+            if (container.array.size() > kArrayContainerMaxSize) {
+                container.bits.assign(1 << 10, 0);
+                for (const auto value: container.array) {
+                    container.bits[value >> 6] |= std::uint64_t(1) << (value & 63);
+                }
+                container.array.clear();
+                container.array.shrink_to_fit();
+            }
+        }
+
+        ++container.size;
+        ++size_;
+        return true;
+    }
+
+    bool CompressedBitmap::Erase(const std::uint64_t vertex_id) {
+        if (!Contains(vertex_id)) {
+            return false;
+        }
+
+        const auto index = std::lower_bound(keys_.begin(), keys_.end(), vertex_id >> 16) - keys_.begin();
+        const auto low = std::uint16_t(vertex_id & 0xFFFF);
+        auto &container = containers_[index];
+
+        if (!container.bits.empty()) {
+            container.bits[low >> 6] &= ~(std::uint64_t(1) << (low & 63));
+
+            // Convert the container back to the array once it fits into half of it, so that the container does not
+            // flip between the representations around the boundary.
+            if (container.size - 1 <= kArrayContainerMaxSize / 2) {
+                for (std::uint32_t word = 0; word < container.bits.size(); ++word) {
+                    for (std::uint64_t bits = container.bits[word]; bits != 0; bits &= bits - 1) {
+                        container.array.push_back(std::uint16_t((word << 6) | std::uint32_t(__builtin_ctzll(bits))));
+                    }
+                }
+                container.bits.clear();
+                container.bits.shrink_to_fit();
+            }
+        } else {
+            container.array.erase(std::lower_bound(container.array.begin(), container.array.end(), low));
+        }
+
+        --size_;
+        if (--container.size == 0) {
+            keys_.erase(keys_.begin() + index);
+            containers_.erase(containers_.begin() + index);
+        }
+        return true;
+    }
+
+    std::uint64_t CompressedBitmap::Size() const {
+        return size_;
+    }
+
+    MemoryFootprint CompressedBitmap::Footprint() const {
+        MemoryFootprint footprint;
+        footprint.AddBuffer<std::uint64_t>(keys_.size(), keys_.capacity());
+        footprint.AddBuffer<Container>(containers_.size(), containers_.capacity());
+        for (const auto &container: containers_) {
+            footprint.AddBuffer<std::uint16_t>(container.array.size(), container.array.capacity());
+            footprint.AddBuffer<std::uint64_t>(container.bits.size(), container.bits.capacity());
+        }
+        return footprint;
+    }
+
+    bool LabelMembership::Contains(const std::uint64_t vertex_id) const {
+        return Visit([vertex_id](const auto &bitmap) { return bitmap.Contains(vertex_id); });
+    }
+
+    void LabelMembership::Insert(const std::uint64_t vertex_id) {
+        std::visit([vertex_id](auto &bitmap) { bitmap.Insert(vertex_id); }, bitmap_);
+        universe_ = std::max(universe_, vertex_id + 1);
+        rebalance();
+    }
+
+    void LabelMembership::Erase(const std::uint64_t vertex_id) {
+        std::visit([vertex_id](auto &bitmap) { bitmap.Erase(vertex_id); }, bitmap_);
+        rebalance();
+    }
+
+    std::uint64_t LabelMembership::Size() const {
+        return Visit([](const auto &bitmap) { return bitmap.Size(); });
+    }
+
+    MemoryFootprint LabelMembership::Footprint() const {
+        return Visit([](const auto &bitmap) { return bitmap.Footprint(); });
+    }
+
+    bool LabelMembership::IsDense() const {
+        return std::holds_alternative<DenseBitmap>(bitmap_);
+    }
+
+    void LabelMembership::rebalance() {
+        const std::uint64_t size = Size();
+
+        if (!IsDense() && size * kDenseRatio >= universe_) {
+            DenseBitmap dense;
+            std::get<CompressedBitmap>(bitmap_).ForEach([&dense](const std::uint64_t vertex) { dense.Insert(vertex); });
+            bitmap_ = std::move(dense);
+        } else if (IsDense() && size * kSparseRatio < universe_) {
+            CompressedBitmap compressed;
+            std::get<DenseBitmap>(bitmap_).ForEach([&compressed](const std::uint64_t vertex) {
+                compressed.Insert(vertex);
+            });
+            bitmap_ = std::move(compressed);
+        }
+    }
+
+} // namespace graph_util
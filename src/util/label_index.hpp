@@ -0,0 +1,257 @@
+#ifndef GRAPHSTORE_LABEL_INDEX_HPP
+#define GRAPHSTORE_LABEL_INDEX_HPP
+
+#include "label_dictionary.hpp"
+#include "memory_usage.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace graph_util {
+
+    ///
+    /// @brief DenseBitmap stores a set of vertices as one bit per vertex ID. Membership test is a single bit test, the
+    /// memory is proportional to the largest stored vertex ID.
+    ///
+    class DenseBitmap {
+    public:
+        /// Creates the empty bitmap
+        DenseBitmap() = default;
+
+        ///
+        /// @brief Creates the empty bitmap with the memory for the passed vertex ID range allocated up front
+        /// @param universe The number of vertex IDs the bitmap can store without growing
+        ///
+        explicit DenseBitmap(std::uint64_t universe);
+
+        ///
+        /// @param vertex_id The vertex ID to check
+        /// @return true if the vertex is in the bitmap, returns false otherwise
+        ///
+        bool Contains(const std::uint64_t vertex_id) const {
+            const std::uint64_t word = vertex_id >> 6;
+            return word < words_.size() && ((words_[word] >> (vertex_id & 63)) & 1) != 0;
+        }
+
+        ///
+        /// @param vertex_id The vertex ID to add
+        /// @return true if the vertex was added, returns false if it's already in the bitmap
+        ///
+        bool Insert(std::uint64_t vertex_id);
+
+        ///
+        /// @param vertex_id The vertex ID to remove
+        /// @return true if the vertex was removed, returns false if it's not in the bitmap
+        ///
+        bool Erase(std::uint64_t vertex_id);
+
+        /// @return The number of vertices in the bitmap
+        std::uint64_t Size() const;
+
+        /// @return The memory of the words, counted by their capacity
+        MemoryFootprint Footprint() const;
+
+        /// Removes all vertices from the bitmap, the allocated memory is kept.
+        void Clear();
+
+        /// Calls visitor for each vertex in the bitmap in increasing order.
+        template<typename Visitor>
+        void ForEach(Visitor &&visitor) const {
+            for (std::uint64_t word = 0; word < words_.size(); ++word) {
+                for (std::uint64_t bits = words_[word]; bits != 0; bits &= bits - 1) {
+                    visitor((word << 6) | std::uint64_t(__builtin_ctzll(bits)));
+                }
+            }
+        }
+
+    private:
+        std::vector<std::uint64_t> words_;
+
+        std::uint64_t size_ = 0;
+    };
+
+    ///
+    /// @brief CompressedBitmap stores a set of vertices in Roaring-style containers. The vertex IDs are split into
+    /// chunks of 2^16 by the high bits, and each non-empty chunk is stored either as a sorted array of the low 16 bits
+    /// or, when it holds more than kArrayContainerMaxSize vertices, as a bitmap of 2^16 bits.
+    ///
+    /// The memory is proportional to the number of stored vertices, which makes the bitmap suitable for the labels
+    /// that are set to a small fraction of the vertices.
+    ///
+    class CompressedBitmap {
+    public:
+        /// The largest number of vertices in an array container, larger containers are stored as bitmaps.
+        static constexpr std::uint32_t kArrayContainerMaxSize = 4096;
+
+        ///
+        /// @param vertex_id The vertex ID to check
+        /// @return true if the vertex is in the bitmap, returns false otherwise
+        ///
+        bool Contains(const std::uint64_t vertex_id) const {
+            const auto it = std::lower_bound(keys_.begin(), keys_.end(), vertex_id >> 16);
+            if (it == keys_.end() || *it != vertex_id >> 16) {
+                return false;
+            }
+
+            const auto &container = containers_[it - keys_.begin()];
+            const auto low = std::uint16_t(vertex_id & 0xFFFF);
+            if (!container.bits.empty()) {
+                return ((container.bits[low >> 6] >> (low & 63)) & 1) != 0;
+            }
+            return std::binary_search(container.array.begin(), container.array.end(), low);
+        }
+
+        ///
+        /// @param vertex_id The vertex ID to add
+        /// @return true if the vertex was added, returns false if it's already in the bitmap
+        ///
+        bool Insert(std::uint64_t vertex_id);
+
+        ///
+        /// @param vertex_id The vertex ID to remove
+        /// @return true if the vertex was removed, returns false if it's not in the bitmap
+        ///
+        bool Erase(std::uint64_t vertex_id);
+
+        /// @return The number of vertices in the bitmap
+        std::uint64_t Size() const;
+
+        /// @return The memory of the keys and the containers, counted by their capacity
+        MemoryFootprint Footprint() const;
+
+        /// Calls visitor for each vertex in the bitmap in increasing order.
+        template<typename Visitor>
+        void ForEach(Visitor &&visitor) const {
+            for (std::size_t i = 0; i < keys_.size(); ++i) {
+                const std::uint64_t high = keys_[i] << 16;
+                const auto &container = containers_[i];
+                if (container.bits.empty()) {
+                    for (const auto low: container.array) {
+                        visitor(high | low);
+                    }
+                    continue;
+                }
+                for (std::uint64_t word = 0; word < container.bits.size(); ++word) {
+                    for (std::uint64_t bits = container.bits[word]; bits != 0; bits &= bits - 1) {
+                        visitor(high | (word << 6) | std::uint64_t(__builtin_ctzll(bits)));
+                    }
+                }
+            }
+        }
+
+    private:
+        // Vertices of one 2^16 chunk, exactly one of array and bits is used.
+        struct Container {
+            // Sorted low 16 bits of the vertices, used while the container is small.
+            std::vector<std::uint16_t> array;
+            // 2^16 bits of the chunk, used once the container outgrows kArrayContainerMaxSize.
+            std::vector<std::uint64_t> bits;
+            // The number of vertices in the container.
+            std::uint32_t size = 0;
+        };
+
+        // Sorted high bits of the non-empty chunks, keys_[i] is the key of containers_[i].
+        std::vector<std::uint64_t> keys_;
+
+        std::vector<Container> containers_;
+
+        std::uint64_t size_ = 0;
+    };
+
+    ///
+    /// @brief LabelMembership is the set of vertices that have one label set. The set is stored either as a
+    /// DenseBitmap or as a CompressedBitmap, and the representation is chosen automatically from the number of the
+    /// vertices relative to the largest vertex ID in the set.
+    ///
+    class LabelMembership {
+    public:
+        /// A label is converted to the dense bitmap once it's set to at least 1/kDenseRatio of the vertex ID range.
+        static constexpr std::uint64_t kDenseRatio = 16;
+
+        /// A dense label is converted back to the compressed bitmap once it drops below 1/kSparseRatio of the range.
+        static constexpr std::uint64_t kSparseRatio = 64;
+
+        ///
+        /// @param vertex_id The vertex ID to check
+        /// @return true if the vertex has the label set, returns false otherwise
+        ///
+        bool Contains(std::uint64_t vertex_id) const;
+
+        ///
+        /// @param vertex_id The vertex ID to add, the method has no effect if the vertex is already in the set
+        ///
+        void Insert(std::uint64_t vertex_id);
+
+        ///
+        /// @param vertex_id The vertex ID to remove, the method has no effect if the vertex is not in the set
+        ///
+        void Erase(std::uint64_t vertex_id);
+
+        /// @return The number of vertices that have the label set
+        std::uint64_t Size() const;
+
+        /// @return The memory of the current bitmap
+        MemoryFootprint Footprint() const;
+
+        /// @return true if the set is currently stored as the DenseBitmap, returns false otherwise
+        bool IsDense() const;
+
+        ///
+        /// @brief Calls visitor with the current bitmap, either DenseBitmap or CompressedBitmap. The traversals use
+        /// it to resolve the representation once per query instead of once per membership test.
+        ///
+        template<typename Visitor>
+        decltype(auto) Visit(Visitor &&visitor) const {
+            return std::visit(std::forward<Visitor>(visitor), bitmap_);
+        }
+
+    private:
+        std::variant<CompressedBitmap, DenseBitmap> bitmap_;
+
+        // The largest vertex ID ever added plus one, the range covered by the dense representation.
+        std::uint64_t universe_ = 0;
+
+        // Switches the representation if the density crossed one of the thresholds.
+        void rebalance();
+    };
+
+    /// Bitmask of the labels set to one vertex, the bit i corresponds to the label with ID i.
+    using LabelMask = std::uint64_t;
+
+    /// The number of labels that fit into LabelMask.
+    constexpr LabelId kLabelMaskWidth = 64;
+
+    ///
+    /// @brief LabelMaskFilter tests whether the vertices have one label set by reading their label masks.
+    ///
+    /// @note In order to not reduce the performance, safety checks are not implemented in the class.
+    /// The passed vertex IDs should be valid and the label ID should be less than kLabelMaskWidth.
+    ///
+    class LabelMaskFilter {
+    public:
+        ///
+        /// @param masks The label masks of all vertices, masks[v] is the label mask of the vertex v
+        /// @param label_id The ID of the label to test
+        ///
+        LabelMaskFilter(const LabelMask *masks, const LabelId label_id) : masks_(masks),
+                                                                          bit_(LabelMask(1) << label_id) {
+        }
+
+        ///
+        /// @param vertex_id The vertex ID to check
+        /// @return true if the vertex has the label set, returns false otherwise
+        ///
+        bool Contains(const std::uint64_t vertex_id) const {
+            return (masks_[vertex_id] & bit_) != 0;
+        }
+
+    private:
+        const LabelMask *masks_;
+        LabelMask bit_;
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_LABEL_INDEX_HPP
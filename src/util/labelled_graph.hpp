@@ -0,0 +1,41 @@
+#ifndef GRAPHSTORE_LABELLED_GRAPH_HPP
+#define GRAPHSTORE_LABELLED_GRAPH_HPP
+
+#include "graph_util.hpp"
+#include "adjacency.hpp"
+#include "label_dictionary.hpp"
+#include "label_index.hpp"
+#include <optional>
+#include <vector>
+
+namespace graph_util {
+
+    ///
+    /// @brief LabelledGraph is a directed unweighted graph where each vertex has set of string labels associated to it.
+    ///
+    struct LabelledGraph {
+        /// The edges of the graph, stored in one of the adjacency layouts.
+        Adjacency neighbours;
+        /// Optional incoming edges of the graph, stored in the same layout as neighbours.
+        std::optional<Adjacency> in_neighbours;
+        /// The dictionary of the interned labels
+        LabelDictionary labels;
+        /// i-th element of label_to_vertices is the set of vertices that have the label with ID i set. If label_masks
+        /// are present, the sets of the labels with IDs less than kLabelMaskWidth are not maintained and stay empty.
+        std::vector<LabelMembership> label_to_vertices;
+        /// Optional label masks, i-th element is the mask of the labels with IDs less than kLabelMaskWidth set to the
+        /// vertex i.
+        std::optional<std::vector<LabelMask>> label_masks;
+
+        ///
+        /// @param label_id The label ID to check, should be valid
+        /// @return true if the label is stored in label_masks instead of label_to_vertices, returns false otherwise
+        ///
+        bool IsMaskedLabel(const LabelId label_id) const {
+            return label_masks.has_value() && label_id < kLabelMaskWidth;
+        }
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_LABELLED_GRAPH_HPP
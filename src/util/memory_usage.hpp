@@ -0,0 +1,149 @@
+#ifndef GRAPHSTORE_MEMORY_USAGE_HPP
+#define GRAPHSTORE_MEMORY_USAGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
+namespace graph_util {
+
+    ///
+    /// @brief The heap memory of one structure.
+    ///
+    struct MemoryFootprint {
+        /// The number of the allocated bytes, the allocator overhead is not counted
+        std::uint64_t allocated = 0;
+        /// The part of the allocated bytes that holds no data: the unused capacity of the buffers and the empty
+        /// buckets of the hash maps
+        std::uint64_t slack = 0;
+
+        MemoryFootprint &operator+=(const MemoryFootprint &other) {
+            allocated += other.allocated;
+            slack += other.slack;
+            return *this;
+        }
+
+        ///
+        /// @brief Adds the buffer with the capacity of capacity elements of type T, of which size are used.
+        ///
+        template<typename T>
+        MemoryFootprint &AddBuffer(const std::uint64_t size, const std::uint64_t capacity) {
+            allocated += capacity * sizeof(T);
+            slack += (capacity - size) * sizeof(T);
+            return *this;
+        }
+    };
+
+    ///
+    /// @brief The breakdown of the Graph Store memory. The parts are disjoint: the bytes of the structures count their
+    /// data only, and the unused capacity of all of them is counted as slack, so the parts sum up to the allocated
+    /// total.
+    ///
+    struct MemoryUsage {
+        /// The data of the outgoing and the incoming adjacencies
+        std::uint64_t adjacency = 0;
+        /// The data of the label dictionary, the per-label vertex sets and the label masks
+        std::uint64_t label_index = 0;
+        /// The data of the idle search states kept for the next queries
+        std::uint64_t vertex_state = 0;
+        /// The allocated bytes of all structures that hold no data
+        std::uint64_t slack = 0;
+
+        /// @return The number of all allocated bytes
+        std::uint64_t Total() const {
+            return adjacency + label_index + vertex_state + slack;
+        }
+    };
+
+    ///
+    /// @brief CountingAllocator allocates with std::allocator and counts the allocated bytes, for the node-based
+    /// containers whose memory can not be computed from their size.
+    ///
+    /// The copies and the rebound copies of an allocator share its counter, so one counter covers the nodes and the
+    /// buckets of a hash map. A copied container starts a new counter. The counter is not atomic: the container should
+    /// not be modified concurrently, as with std::allocator.
+    ///
+    template<typename T>
+    class CountingAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        /// Creates the allocator with a new counter
+        CountingAllocator() : allocated_bytes_(std::make_shared<std::uint64_t>(0)) {
+        }
+
+        // No move constructor: a moved-from container should keep counting into its own counter.
+        CountingAllocator(const CountingAllocator &other) noexcept = default;
+
+        template<typename U>
+        CountingAllocator(const CountingAllocator<U> &other) noexcept : allocated_bytes_(other.allocated_bytes_) {
+        }
+
+        CountingAllocator &operator=(const CountingAllocator &other) noexcept = default;
+
+        T *allocate(const std::size_t count) {
+            T *result = std::allocator<T>().allocate(count);
+            *allocated_bytes_ += count * sizeof(T);
+            return result;
+        }
+
+        void deallocate(T *pointer, const std::size_t count) noexcept {
+            std::allocator<T>().deallocate(pointer, count);
+            *allocated_bytes_ -= count * sizeof(T);
+        }
+
+        /// @return The allocator of the copied container, with a new counter
+        CountingAllocator select_on_container_copy_construction() const {
+            return CountingAllocator();
+        }
+
+        /// @return The number of the bytes allocated and not yet deallocated through the allocator and its copies
+        std::uint64_t AllocatedBytes() const {
+            return *allocated_bytes_;
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U> &other) const noexcept {
+            return allocated_bytes_ == other.allocated_bytes_;
+        }
+
+        template<typename U>
+        bool operator!=(const CountingAllocator<U> &other) const noexcept {
+            return allocated_bytes_ != other.allocated_bytes_;
+        }
+
+    private:
+        template<typename U>
+        friend class CountingAllocator;
+
+        std::shared_ptr<std::uint64_t> allocated_bytes_;
+    };
+
+    /// std::unordered_map counting its memory with CountingAllocator
+    template<typename Key, typename Value>
+    using CountedHashMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>,
+            CountingAllocator<std::pair<const Key, Value>>>;
+
+    ///
+    /// @param map The hash map to measure
+    /// @return The memory of the nodes and the buckets of the map, the empty buckets are counted as slack
+    ///
+    template<typename Key, typename Value>
+    MemoryFootprint HashMapFootprint(const CountedHashMap<Key, Value> &map) {
+        MemoryFootprint footprint;
+        footprint.allocated = map.get_allocator().AllocatedBytes();
+        // The single bucket of an empty map may be stored inline, so the slack is capped by the allocated bytes.
+        const std::uint64_t empty_buckets = map.bucket_count() > map.size() ? map.bucket_count() - map.size() : 0;
+        footprint.slack = std::min<std::uint64_t>(empty_buckets * sizeof(void *), footprint.allocated);
+        return footprint;
+    }
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_MEMORY_USAGE_HPP
@@ -0,0 +1,200 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace graph_util {
+
+    namespace {
+
+        // The latencies below are exact, every larger power of two range is split into kSubBucketCount buckets.
+        constexpr std::uint64_t kExactLimit = 16;
+        constexpr std::uint64_t kSubBucketBits = 3;
+        constexpr std::uint64_t kSubBucketCount = std::uint64_t(1) << kSubBucketBits;
+
+        // The largest latency with its own bucket, the longer latencies are recorded in the last bucket.
+        constexpr std::uint64_t kMaxTrackedNanoseconds = (std::uint64_t(1) << 40) - 1;
+
+        // The powers of two of nanoseconds exported as the Prometheus buckets, from 256 ns to about 69 s.
+        constexpr unsigned kFirstExportedPower = 8;
+        constexpr unsigned kLastExportedPower = 36;
+
+        // Hands out the shard ordinals to the threads in the order of their first Record call.
+        std::atomic<std::size_t> next_thread_ordinal{0};
+
+        // Formats the nanoseconds as seconds with all 9 decimal digits, so that the bucket bounds are exact.
+        std::string seconds(const std::uint64_t nanoseconds) {
+            std::string fraction = std::to_string(nanoseconds % 1000000000);
+            return std::to_string(nanoseconds / 1000000000) + "." + std::string(9 - fraction.size(), '0') + fraction;
+        }
+
+    } // namespace
+
+    const char *OperationName(const Operation operation) {
+        switch (operation) {
+            case Operation::CREATE_VERTEX:
+                return "create_vertex";
+            case Operation::CREATE_EDGE:
+                return "create_edge";
+            case Operation::ADD_LABEL:
+                return "add_label";
+            case Operation::REMOVE_LABEL:
+                return "remove_label";
+            case Operation::SHORTEST_PATH:
+                return "shortest_path";
+            case Operation::SHORTEST_PATH_BATCH:
+                return "shortest_path_batch";
+        }
+        return "unknown";
+    }
+
+    std::size_t LatencyHistogram::BucketIndex(std::uint64_t nanoseconds) {
+        if (nanoseconds < kExactLimit) {
+            return nanoseconds;
+        }
+        nanoseconds = std::min(nanoseconds, kMaxTrackedNanoseconds);
+        // The top kSubBucketBits + 1 bits of the latency, the highest one is always set.
+        const std::uint64_t shift = 63 - __builtin_clzll(nanoseconds) - kSubBucketBits;
+        return shift * kSubBucketCount + (nanoseconds >> shift);
+    }
+
+    std::uint64_t LatencyHistogram::BucketLowerBound(const std::size_t bucket) {
+        if (bucket < kExactLimit) {
+            return bucket;
+        }
+        const std::uint64_t shift = bucket / kSubBucketCount - 1;
+        return (bucket % kSubBucketCount + kSubBucketCount) << shift;
+    }
+
+    std::uint64_t LatencyHistogram::BucketUpperBound(const std::size_t bucket) {
+        if (bucket < kExactLimit) {
+            return bucket + 1;
+        }
+        const std::uint64_t shift = bucket / kSubBucketCount - 1;
+        return (bucket % kSubBucketCount + kSubBucketCount + 1) << shift;
+    }
+
+    std::chrono::nanoseconds OperationMetrics::Percentile(const double quantile) const {
+        if (count == 0) {
+            return std::chrono::nanoseconds(0);
+        }
+        const auto rank = std::max<std::uint64_t>(1, std::uint64_t(std::ceil(quantile * double(count))));
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+            seen += buckets[bucket];
+            if (seen >= rank) {
+                return std::chrono::nanoseconds(LatencyHistogram::BucketUpperBound(bucket) - 1);
+            }
+        }
+        // The collected buckets may miss the calls recorded concurrently with the collection.
+        return std::chrono::nanoseconds(LatencyHistogram::BucketUpperBound(buckets.size() - 1) - 1);
+    }
+
+    std::string ToPrometheusText(const StoreMetrics &metrics) {
+        std::ostringstream out;
+
+        out << "# HELP graph_store_operations_total The number of the completed Graph Store operations.\n"
+            << "# TYPE graph_store_operations_total counter\n";
+        for (std::size_t i = 0; i < kOperationCount; ++i) {
+            out << "graph_store_operations_total{operation=\"" << OperationName(Operation(i)) << "\"} "
+                << metrics.operations[i].count << "\n";
+        }
+
+        out << "# HELP graph_store_operation_duration_seconds The latency of the Graph Store operations.\n"
+            << "# TYPE graph_store_operation_duration_seconds histogram\n";
+        for (std::size_t i = 0; i < kOperationCount; ++i) {
+            const auto &operation = metrics.operations[i];
+            const std::string name = OperationName(Operation(i));
+
+            // The power of two bounds are bucket bounds of LatencyHistogram, so the cumulative counts are exact.
+            std::size_t bucket = 0;
+            std::uint64_t cumulative = 0;
+            for (unsigned power = kFirstExportedPower; power <= kLastExportedPower; ++power) {
+                const std::uint64_t bound = std::uint64_t(1) << power;
+                for (; LatencyHistogram::BucketUpperBound(bucket) <= bound; ++bucket) {
+                    cumulative += operation.buckets[bucket];
+                }
+                out << "graph_store_operation_duration_seconds_bucket{operation=\"" << name << "\",le=\""
+                    << seconds(bound) << "\"} " << cumulative << "\n";
+            }
+            out << "graph_store_operation_duration_seconds_bucket{operation=\"" << name << "\",le=\"+Inf\"} "
+                << operation.count << "\n"
+                << "graph_store_operation_duration_seconds_sum{operation=\"" << name << "\"} "
+                << seconds(std::uint64_t(operation.total_time.count())) << "\n"
+                << "graph_store_operation_duration_seconds_count{operation=\"" << name << "\"} "
+                << operation.count << "\n";
+        }
+
+        out << "# HELP graph_store_vertices The number of vertices in the graph.\n"
+            << "# TYPE graph_store_vertices gauge\n"
+            << "graph_store_vertices " << metrics.vertex_count << "\n"
+            << "# HELP graph_store_edges The number of edges in the graph.\n"
+            << "# TYPE graph_store_edges gauge\n"
+            << "graph_store_edges " << metrics.edge_count << "\n"
+            << "# HELP graph_store_labels The number of interned labels.\n"
+            << "# TYPE graph_store_labels gauge\n"
+            << "graph_store_labels " << metrics.label_count << "\n";
+
+        out << "# HELP graph_store_memory_bytes The heap memory of the Graph Store structures, their unused capacity "
+               "as slack.\n"
+            << "# TYPE graph_store_memory_bytes gauge\n";
+        for (const auto &[structure, bytes]: metrics.memory_bytes) {
+            out << "graph_store_memory_bytes{structure=\"" << structure << "\"} " << bytes << "\n";
+        }
+        return out.str();
+    }
+
+    MetricsRegistry::MetricsRegistry() = default;
+
+    MetricsRegistry::~MetricsRegistry() {
+        for (auto &shard: shards_) {
+            delete shard.load(std::memory_order_relaxed);
+        }
+    }
+
+    void MetricsRegistry::Record(const Operation operation, const std::chrono::nanoseconds latency) {
+        const auto nanoseconds = std::uint64_t(std::max<std::int64_t>(0, latency.count()));
+        auto &counters = shard().operations[std::size_t(operation)];
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.total_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+        counters.buckets[LatencyHistogram::BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::array<OperationMetrics, kOperationCount> MetricsRegistry::Collect() const {
+        std::array<OperationMetrics, kOperationCount> result;
+        for (const auto &slot: shards_) {
+            const Shard *shard = slot.load(std::memory_order_acquire);
+            if (shard == nullptr) {
+                continue;
+            }
+            for (std::size_t i = 0; i < kOperationCount; ++i) {
+                const auto &counters = shard->operations[i];
+                result[i].count += counters.count.load(std::memory_order_relaxed);
+                result[i].total_time += std::chrono::nanoseconds(
+                        counters.total_nanoseconds.load(std::memory_order_relaxed));
+                for (std::size_t bucket = 0; bucket < LatencyHistogram::kBucketCount; ++bucket) {
+                    result[i].buckets[bucket] += counters.buckets[bucket].load(std::memory_order_relaxed);
+                }
+            }
+        }
+        return result;
+    }
+
+    MetricsRegistry::Shard &MetricsRegistry::shard() {
+        thread_local const std::size_t thread_ordinal = next_thread_ordinal.fetch_add(1, std::memory_order_relaxed);
+        auto &slot = shards_[thread_ordinal % kShardCount];
+
+        Shard *shard = slot.load(std::memory_order_acquire);
+        if (shard == nullptr) {
+            // Another thread mapped to the slot may allocate it at the same time, the loser frees its copy.
+            auto *allocated = new Shard();
+            if (slot.compare_exchange_strong(shard, allocated, std::memory_order_acq_rel)) {
+                shard = allocated;
+            } else {
+                delete allocated;
+            }
+        }
+        return *shard;
+    }
+
+} // namespace graph_util
@@ -0,0 +1,201 @@
+#ifndef GRAPHSTORE_METRICS_HPP
+#define GRAPHSTORE_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graph_util {
+
+    /// The operations of the Graph Store with the recorded count and latency
+    enum class Operation {
+        CREATE_VERTEX,
+        CREATE_EDGE,
+        ADD_LABEL,
+        REMOVE_LABEL,
+        SHORTEST_PATH,
+        /// One ShortestPathBatch call, whatever the number of its queries
+        SHORTEST_PATH_BATCH
+    };
+
+    /// The number of the values of Operation
+    constexpr std::size_t kOperationCount = 6;
+
+    ///
+    /// @param operation The operation to name
+    /// @return The name of the operation in the exported metrics, e.g. "create_vertex"
+    ///
+    const char *OperationName(Operation operation);
+
+    ///
+    /// @brief LatencyHistogram maps the latencies to the buckets of a log-linear histogram in the style of
+    /// HdrHistogram: the latencies below 16 ns have a bucket each, and every larger power of two range is split into
+    /// 8 equal buckets. A bucket is then at most 12.5% wide relative to its values, from nanoseconds to minutes, with
+    /// a fixed number of buckets and no configuration.
+    ///
+    class LatencyHistogram {
+    public:
+        /// The number of the buckets, the latencies of 2^40 ns (about 18 minutes) and more fall into the last one
+        static constexpr std::size_t kBucketCount = 304;
+
+        ///
+        /// @param nanoseconds The latency to map
+        /// @return The index of the bucket of the latency
+        ///
+        static std::size_t BucketIndex(std::uint64_t nanoseconds);
+
+        ///
+        /// @param bucket The index of the bucket, less than kBucketCount
+        /// @return The smallest latency in nanoseconds that falls into the bucket
+        ///
+        static std::uint64_t BucketLowerBound(std::size_t bucket);
+
+        ///
+        /// @param bucket The index of the bucket, less than kBucketCount
+        /// @return The smallest latency in nanoseconds above the bucket
+        ///
+        static std::uint64_t BucketUpperBound(std::size_t bucket);
+    };
+
+    ///
+    /// @brief The count and the latency distribution of one operation, summed over all threads since the Graph Store
+    /// was created.
+    ///
+    struct OperationMetrics {
+        /// The number of the completed calls
+        std::uint64_t count = 0;
+        /// The total latency of the calls
+        std::chrono::nanoseconds total_time{0};
+        /// The number of the calls per LatencyHistogram bucket
+        std::array<std::uint64_t, LatencyHistogram::kBucketCount> buckets{};
+
+        ///
+        /// @param quantile The quantile from 0 to 1, e.g. 0.99 for the 99th percentile
+        /// @return The largest latency of the bucket holding the quantile, at most 12.5% above the exact one, or zero
+        /// if no call was recorded
+        ///
+        std::chrono::nanoseconds Percentile(double quantile) const;
+    };
+
+    ///
+    /// @brief A point-in-time view of the Graph Store metrics: the counters and the latency histograms of the
+    /// operations, and the gauges of the graph size and of the memory of its structures.
+    ///
+    struct StoreMetrics {
+        /// The metrics of every operation, indexed by Operation
+        std::array<OperationMetrics, kOperationCount> operations;
+        /// The number of vertices in the graph
+        std::uint64_t vertex_count = 0;
+        /// The number of edges in the graph
+        std::uint64_t edge_count = 0;
+        /// The number of interned labels
+        std::uint64_t label_count = 0;
+        /// The bytes of the GraphStore::MemoryUsage breakdown, by the name of the structure or "slack"
+        std::vector<std::pair<std::string, std::uint64_t>> memory_bytes;
+
+        /// @return The metrics of the operation
+        const OperationMetrics &operator[](const Operation operation) const {
+            return operations[std::size_t(operation)];
+        }
+    };
+
+    ///
+    /// @brief Formats the metrics in the Prometheus text exposition format: the operation counters as
+    /// graph_store_operations_total, the latencies as the histogram graph_store_operation_duration_seconds with one
+    /// bucket per power of two of nanoseconds, the sizes as the gauges graph_store_vertices, graph_store_edges and
+    /// graph_store_labels, and the memory as the gauge graph_store_memory_bytes labelled by the structure.
+    ///
+    /// @param metrics The metrics to format
+    /// @return The text to serve on the metrics endpoint
+    ///
+    std::string ToPrometheusText(const StoreMetrics &metrics);
+
+    ///
+    /// @brief MetricsRegistry accumulates the counts and the latencies of the operations. Every thread records into
+    /// its own shard with relaxed atomic additions, so that the concurrent operations do not share cache lines or
+    /// locks. The shards are allocated on first use and summed by Collect.
+    ///
+    class MetricsRegistry {
+    public:
+        /// The number of the shards, the threads beyond it share the shards
+        static constexpr std::size_t kShardCount = 64;
+
+        MetricsRegistry();
+
+        /// Frees the shards
+        ~MetricsRegistry();
+
+        MetricsRegistry(const MetricsRegistry &) = delete;
+
+        MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+        ///
+        /// @brief Records one completed call of the operation, may be called from any number of threads at once.
+        /// @param operation The completed operation
+        /// @param latency The latency of the call
+        ///
+        void Record(Operation operation, std::chrono::nanoseconds latency);
+
+        ///
+        /// @brief Sums the shards. The calls recorded concurrently may be partially included: the count of a call
+        /// may be summed before or after its bucket.
+        /// @return The metrics of every operation, indexed by Operation
+        ///
+        std::array<OperationMetrics, kOperationCount> Collect() const;
+
+    private:
+        // The counters of one operation in one shard.
+        struct Counters {
+            std::atomic<std::uint64_t> count{0};
+            std::atomic<std::uint64_t> total_nanoseconds{0};
+            std::array<std::atomic<std::uint64_t>, LatencyHistogram::kBucketCount> buckets{};
+        };
+
+        // The counters of all operations recorded by the threads mapped to the shard, aligned to keep the shards
+        // on separate cache lines.
+        struct alignas(64) Shard {
+            std::array<Counters, kOperationCount> operations;
+        };
+
+        std::array<std::atomic<Shard *>, kShardCount> shards_{};
+
+        // Returns the shard of the calling thread, allocates it if it's not allocated yet.
+        Shard &shard();
+    };
+
+    ///
+    /// @brief OperationTimer records the latency of the operation from its construction to its destruction into the
+    /// registry, or does nothing if the registry is nullptr.
+    ///
+    class OperationTimer {
+    public:
+        OperationTimer(MetricsRegistry *registry, const Operation operation) :
+                registry_(registry), operation_(operation),
+                start_(registry != nullptr ? std::chrono::steady_clock::now()
+                                           : std::chrono::steady_clock::time_point()) {
+        }
+
+        ~OperationTimer() {
+            if (registry_ != nullptr) {
+                registry_->Record(operation_, std::chrono::steady_clock::now() - start_);
+            }
+        }
+
+        OperationTimer(const OperationTimer &) = delete;
+
+        OperationTimer &operator=(const OperationTimer &) = delete;
+
+    private:
+        MetricsRegistry *registry_;
+        Operation operation_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_METRICS_HPP
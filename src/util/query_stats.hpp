@@ -0,0 +1,145 @@
+#ifndef GRAPHSTORE_QUERY_STATS_HPP
+#define GRAPHSTORE_QUERY_STATS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace graph_util {
+
+    ///
+    /// @brief The execution statistics of one shortest path query.
+    ///
+    struct QueryStats {
+        /// The number of vertices whose edges were scanned: the dequeued vertices of the top-down searches and the
+        /// unvisited vertices checked by the bottom-up steps
+        std::uint64_t vertices_dequeued = 0;
+        /// The number of scanned edges, including the edges to the vertices without the label
+        std::uint64_t edges_scanned = 0;
+        /// The number of vertices skipped because they do not have the label
+        std::uint64_t label_rejections = 0;
+        /// The deepest level the search discovered vertices at, the sum of both depths for the bidirectional search
+        std::uint64_t level_reached = 0;
+        /// The number of vertices the search stored in the vertex states, the touched set reset after the query
+        std::uint64_t touched_vertices = 0;
+        /// The time of the search itself
+        std::chrono::nanoseconds search_time{0};
+        /// The time of the path reconstruction from the parents
+        std::chrono::nanoseconds path_time{0};
+        /// The time of the vertex state reset after the query
+        std::chrono::nanoseconds reset_time{0};
+    };
+
+    /// The phases of the query time in QueryStats
+    enum class QueryPhase {
+        SEARCH,
+        PATH,
+        RESET
+    };
+
+    ///
+    /// @brief QueryStatsRecorder collects QueryStats of a query. The searches are templates over the recorder, so the
+    /// same code is compiled with NoQueryStatsRecorder for the queries without statistics.
+    ///
+    class QueryStatsRecorder {
+    public:
+        /// true if the recorder collects the statistics
+        static constexpr bool kEnabled = true;
+
+        /// Records a vertex whose edges are scanned
+        void VertexDequeued() {
+            ++stats_.vertices_dequeued;
+        }
+
+        /// Records a scanned edge
+        void EdgeScanned() {
+            ++stats_.edges_scanned;
+        }
+
+        /// Records a vertex skipped because it does not have the label
+        void LabelRejected() {
+            ++stats_.label_rejections;
+        }
+
+        /// Records a vertex discovered at the level
+        void LevelReached(const std::uint64_t level) {
+            stats_.level_reached = std::max(stats_.level_reached, level);
+        }
+
+        /// Records a vertex stored in the vertex state
+        void VertexTouched() {
+            ++stats_.touched_vertices;
+        }
+
+        /// Starts timing the first phase
+        void StartTimer() {
+            lap_start_ = std::chrono::steady_clock::now();
+        }
+
+        /// Adds the time since the previous lap to the phase and starts timing the next one
+        void Lap(const QueryPhase phase) {
+            const auto now = std::chrono::steady_clock::now();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - lap_start_);
+            switch (phase) {
+                case QueryPhase::SEARCH:
+                    stats_.search_time += elapsed;
+                    break;
+                case QueryPhase::PATH:
+                    stats_.path_time += elapsed;
+                    break;
+                case QueryPhase::RESET:
+                    stats_.reset_time += elapsed;
+                    break;
+            }
+            lap_start_ = now;
+        }
+
+        /// Adds the counters of the recorder, used to join the recorders of the threads
+        void Merge(const QueryStatsRecorder &other) {
+            stats_.vertices_dequeued += other.stats_.vertices_dequeued;
+            stats_.edges_scanned += other.stats_.edges_scanned;
+            stats_.label_rejections += other.stats_.label_rejections;
+            stats_.level_reached = std::max(stats_.level_reached, other.stats_.level_reached);
+            stats_.touched_vertices += other.stats_.touched_vertices;
+        }
+
+        /// @return The collected statistics
+        const QueryStats &Stats() const {
+            return stats_;
+        }
+
+    private:
+        QueryStats stats_;
+
+        std::chrono::steady_clock::time_point lap_start_;
+    };
+
+    ///
+    /// @brief NoQueryStatsRecorder has the interface of QueryStatsRecorder and does nothing, the calls are inlined
+    /// away from the search loops.
+    ///
+    class NoQueryStatsRecorder {
+    public:
+        /// true if the recorder collects the statistics
+        static constexpr bool kEnabled = false;
+
+        void VertexDequeued() {}
+
+        void EdgeScanned() {}
+
+        void LabelRejected() {}
+
+        void LevelReached(std::uint64_t) {}
+
+        void VertexTouched() {}
+
+        void StartTimer() {}
+
+        void Lap(QueryPhase) {}
+
+        void Merge(const NoQueryStatsRecorder &) {}
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_QUERY_STATS_HPP
@@ -0,0 +1,91 @@
+#ifndef GRAPHSTORE_SHARED_CHUNK_VECTOR_HPP
+#define GRAPHSTORE_SHARED_CHUNK_VECTOR_HPP
+
+#include "memory_usage.hpp"
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace graph_util {
+
+    ///
+    /// @brief SharedChunkVector is a vector split into chunks of kChunkSize elements that are shared by its copies.
+    /// Copying the vector takes O(size / kChunkSize) time, and the first modification of a shared chunk copies only
+    /// that chunk, so a copy made for a snapshot costs a fraction of the copy of the whole vector.
+    ///
+    /// A chunk is shared while another vector holds it. The vector should not be copied concurrently with its
+    /// modification, as with std::vector.
+    ///
+    template<typename T>
+    class SharedChunkVector {
+    public:
+        /// The number of elements of every chunk but the last one
+        static constexpr std::uint64_t kChunkSize = 1024;
+
+        /// @return The number of elements
+        std::uint64_t Size() const {
+            return size_;
+        }
+
+        ///
+        /// @param index The index of the element, less than Size()
+        /// @return The element for reading
+        ///
+        const T &operator[](const std::uint64_t index) const {
+            return (*chunks_[index / kChunkSize])[index % kChunkSize];
+        }
+
+        ///
+        /// @param index The index of the element, less than Size()
+        /// @return The element for modification, its chunk is copied first if it's shared with another vector
+        ///
+        T &Mutable(const std::uint64_t index) {
+            return mutableChunk(index / kChunkSize)[index % kChunkSize];
+        }
+
+        ///
+        /// @brief Appends the element, the last chunk is copied first if it's shared with another vector.
+        ///
+        void PushBack(T value) {
+            if (size_ % kChunkSize == 0) {
+                chunks_.push_back(std::make_shared<std::vector<T>>());
+                chunks_.back()->reserve(kChunkSize);
+            }
+            mutableChunk(size_ / kChunkSize).push_back(std::move(value));
+            ++size_;
+        }
+
+        /// @return The memory of the chunks, counted by their capacity, without the memory owned by the elements. The
+        /// chunks may be shared with the copies of the vector.
+        MemoryFootprint Footprint() const {
+            MemoryFootprint footprint;
+            footprint.AddBuffer<std::shared_ptr<std::vector<T>>>(chunks_.size(), chunks_.capacity());
+            for (const auto &chunk: chunks_) {
+                footprint.AddBuffer<std::vector<T>>(1, 1);
+                footprint.AddBuffer<T>(chunk->size(), chunk->capacity());
+            }
+            return footprint;
+        }
+
+    private:
+        std::vector<std::shared_ptr<std::vector<T>>> chunks_;
+
+        std::uint64_t size_ = 0;
+
+        // Returns the chunk, copies it first if it's shared with another vector.
+        std::vector<T> &mutableChunk(const std::uint64_t chunk_index) {
+            auto &chunk = chunks_[chunk_index];
+            if (chunk.use_count() > 1) {
+                auto copy = std::make_shared<std::vector<T>>();
+                copy->reserve(kChunkSize);
+                copy->assign(chunk->begin(), chunk->end());
+                chunk = std::move(copy);
+            }
+            return *chunk;
+        }
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_SHARED_CHUNK_VECTOR_HPP
@@ -0,0 +1,133 @@
+#include "snapshot_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graph_util {
+
+    SnapshotWriter::SnapshotWriter(std::string path) : path_(std::move(path)), temporary_path_(path_ + ".tmp"),
+                                                       file_(std::fopen(temporary_path_.c_str(), "wb")) {
+        if (file_ == nullptr) {
+            throw std::runtime_error("Failed to create the snapshot file " + temporary_path_ + ".");
+        }
+        buffer_.reserve(kBufferWords);
+
+        // The header is written last, once the positions of the sections are known.
+        for (std::size_t i = 0; i < sizeof(SnapshotHeader) / sizeof(std::uint64_t); ++i) {
+            WriteWord(0);
+        }
+    }
+
+    SnapshotWriter::~SnapshotWriter() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            std::remove(temporary_path_.c_str());
+        }
+    }
+
+    std::uint64_t SnapshotWriter::Position() const {
+        return written_bytes_ + buffer_.size() * sizeof(std::uint64_t);
+    }
+
+    void SnapshotWriter::WriteWord(const std::uint64_t word) {
+        buffer_.push_back(word);
+        if (buffer_.size() == kBufferWords) {
+            flush();
+        }
+    }
+
+    void SnapshotWriter::WriteVertexId(const VertexId vertex_id) {
+        std::memcpy(reinterpret_cast<std::uint8_t *>(&pending_word_) + pending_bytes_, &vertex_id, sizeof(vertex_id));
+        pending_bytes_ += sizeof(vertex_id);
+        if (pending_bytes_ == sizeof(std::uint64_t)) {
+            PadToWord();
+        }
+    }
+
+    void SnapshotWriter::PadToWord() {
+        if (pending_bytes_ == 0) {
+            return;
+        }
+        WriteWord(pending_word_);
+        pending_word_ = 0;
+        pending_bytes_ = 0;
+    }
+
+    void SnapshotWriter::WriteBytes(const std::string &data) {
+        for (std::size_t i = 0; i < data.size(); i += sizeof(std::uint64_t)) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, data.data() + i, std::min(sizeof(std::uint64_t), data.size() - i));
+            WriteWord(word);
+        }
+    }
+
+    void SnapshotWriter::Finish(SnapshotHeader header) {
+        flush();
+        header.file_size = written_bytes_;
+
+        const bool written = std::fseek(file_, 0, SEEK_SET) == 0 &&
+                             std::fwrite(&header, sizeof(header), 1, file_) == 1 &&
+                             std::fflush(file_) == 0 && ::fsync(::fileno(file_)) == 0;
+        const bool closed = std::fclose(file_) == 0;
+        file_ = nullptr;
+        if (!written || !closed || std::rename(temporary_path_.c_str(), path_.c_str()) != 0) {
+            std::remove(temporary_path_.c_str());
+            throw std::runtime_error("Failed to write the snapshot file " + path_ + ".");
+        }
+    }
+
+    void SnapshotWriter::flush() {
+        if (buffer_.empty()) {
+            return;
+        }
+        if (std::fwrite(buffer_.data(), sizeof(std::uint64_t), buffer_.size(), file_) != buffer_.size()) {
+            throw std::runtime_error("Failed to write the snapshot file " + temporary_path_ + ".");
+        }
+        written_bytes_ += buffer_.size() * sizeof(std::uint64_t);
+        buffer_.clear();
+    }
+
+    MappedFile::MappedFile(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open the file " + path + ".");
+        }
+
+        struct stat file_stat{};
+        if (::fstat(fd, &file_stat) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to read the size of the file " + path + ".");
+        }
+        size_ = std::uint64_t(file_stat.st_size);
+
+        if (size_ != 0) {
+            void *data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to map the file " + path + ".");
+            }
+            data_ = static_cast<const std::uint8_t *>(data);
+        }
+        // The mapping stays valid after the descriptor is closed.
+        ::close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<std::uint8_t *>(data_), size_);
+        }
+    }
+
+    const std::uint8_t *MappedFile::Data() const {
+        return data_;
+    }
+
+    std::uint64_t MappedFile::Size() const {
+        return size_;
+    }
+
+} // namespace graph_util
@@ -0,0 +1,151 @@
+#ifndef GRAPHSTORE_SNAPSHOT_FILE_HPP
+#define GRAPHSTORE_SNAPSHOT_FILE_HPP
+
+#include "graph_util.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace graph_util {
+
+    ///
+    /// @brief The header at the beginning of a snapshot file. The file stores the words in the native byte order, and
+    /// every section starts at a multiple of 8 bytes, so that the mapped arrays can be read in place.
+    ///
+    /// The sections are:
+    ///     - the CSR offsets of the outgoing edges, vertex_count + 1 words
+    ///     - the CSR targets of the outgoing edges, edge_count vertex IDs of 4 bytes if kVertexIds32 is set and of 8
+    ///       bytes otherwise, padded to a multiple of 8 bytes
+    ///     - optionally the CSR offsets and targets of the incoming edges, in the same format
+    ///     - the labels in the order of their IDs: the label length, the number of the vertices with the label, the
+    ///       label bytes padded to a multiple of 8 and the sorted vertex IDs
+    ///
+    struct SnapshotHeader {
+        /// The magic bytes "GSTSNAP" followed by a zero byte
+        static constexpr std::uint64_t kMagic = 0x0050414e53545347;
+        /// The version of the format, incremented on every incompatible change
+        static constexpr std::uint32_t kVersion = 3;
+        /// The flag set if the incoming edges are stored
+        static constexpr std::uint32_t kHasInEdges = 1;
+        /// The flag set if the vertex IDs of the CSR targets are stored in 32 bits
+        static constexpr std::uint32_t kVertexIds32 = 2;
+
+        std::uint64_t magic = kMagic;
+        std::uint32_t version = kVersion;
+        std::uint32_t flags = 0;
+        std::uint64_t vertex_count = 0;
+        std::uint64_t edge_count = 0;
+        std::uint64_t label_count = 0;
+        /// The sequence number of the last write-ahead log record reflected in the snapshot
+        std::uint64_t sequence_number = 0;
+        /// The byte positions of the sections, the positions of the incoming edges are 0 if they are not stored
+        std::uint64_t out_offsets_position = 0;
+        std::uint64_t out_targets_position = 0;
+        std::uint64_t in_offsets_position = 0;
+        std::uint64_t in_targets_position = 0;
+        std::uint64_t labels_position = 0;
+        /// The size of the whole file in bytes
+        std::uint64_t file_size = 0;
+    };
+
+    ///
+    /// @brief SnapshotWriter writes a snapshot file through a buffer. The file is written under a temporary name and
+    /// renamed on Finish, so that the processes that mapped the previous file at the same path keep reading it intact.
+    ///
+    class SnapshotWriter {
+    public:
+        ///
+        /// @brief Creates the temporary file and reserves the space of the header.
+        /// @param path The path of the snapshot file
+        /// @throws std::runtime_error if the file can not be created
+        ///
+        explicit SnapshotWriter(std::string path);
+
+        /// Removes the temporary file unless Finish succeeded.
+        ~SnapshotWriter();
+
+        SnapshotWriter(const SnapshotWriter &) = delete;
+
+        SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+        /// @return The byte position of the next written word
+        std::uint64_t Position() const;
+
+        /// @param word The word to append
+        void WriteWord(std::uint64_t word);
+
+        ///
+        /// @brief Appends the vertex ID in the stored width, the IDs are packed into words until PadToWord.
+        /// @param vertex_id The vertex ID to append
+        ///
+        void WriteVertexId(VertexId vertex_id);
+
+        /// Pads the packed vertex IDs with zeros to a multiple of 8 bytes.
+        void PadToWord();
+
+        ///
+        /// @brief Appends the bytes, padded with zeros to a multiple of 8 bytes.
+        /// @param data The bytes to append
+        ///
+        void WriteBytes(const std::string &data);
+
+        ///
+        /// @brief Writes the header, flushes the file and replaces the file at the path with it.
+        /// @param header The header of the file, file_size is set by the method
+        /// @throws std::runtime_error if the file can not be written
+        ///
+        void Finish(SnapshotHeader header);
+
+    private:
+        // The number of words collected before they are written to the file.
+        static constexpr std::size_t kBufferWords = 1 << 16;
+
+        std::string path_;
+        std::string temporary_path_;
+        std::FILE *file_;
+        std::vector<std::uint64_t> buffer_;
+        // The number of bytes written to the file, not counting the buffer.
+        std::uint64_t written_bytes_ = 0;
+
+        // The vertex IDs packed by WriteVertexId that do not fill a word yet.
+        std::uint64_t pending_word_ = 0;
+        std::size_t pending_bytes_ = 0;
+
+        // Writes the buffered words to the file.
+        void flush();
+    };
+
+    ///
+    /// @brief MappedFile maps a whole file into the memory read-only. The pages are loaded on first access and shared
+    /// with the other processes mapping the same file.
+    ///
+    class MappedFile {
+    public:
+        ///
+        /// @param path The path of the file to map
+        /// @throws std::runtime_error if the file can not be opened or mapped
+        ///
+        explicit MappedFile(const std::string &path);
+
+        /// Unmaps the file.
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /// @return The first byte of the mapping, nullptr for the empty file
+        const std::uint8_t *Data() const;
+
+        /// @return The size of the file in bytes
+        std::uint64_t Size() const;
+
+    private:
+        const std::uint8_t *data_ = nullptr;
+        std::uint64_t size_ = 0;
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_SNAPSHOT_FILE_HPP
@@ -0,0 +1,76 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace graph_util {
+
+    ThreadPool::ThreadPool(std::size_t thread_count) {
+        if (thread_count == 0) {
+            thread_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        workers_.reserve(thread_count - 1);
+        for (std::size_t i = 1; i < thread_count; ++i) {
+            workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        task_ready_.notify_all();
+
+        for (auto &worker: workers_) {
+            worker.join();
+        }
+    }
+
+    std::size_t ThreadPool::ThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    void ThreadPool::Run(const std::function<void(std::size_t)> &task) {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            running_workers_ = workers_.size();
+            ++generation_;
+        }
+        task_ready_.notify_all();
+
+        task(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        task_done_.wait(lock, [this] { return running_workers_ == 0; });
+        task_ = nullptr;
+    }
+
+    void ThreadPool::workerLoop(const std::size_t thread_index) {
+        std::uint64_t last_generation = 0;
+
+        while (true) {
+            const std::function<void(std::size_t)> *task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_ready_.wait(lock, [this, last_generation] { return stop_ || generation_ != last_generation; });
+                if (stop_) {
+                    return;
+                }
+                last_generation = generation_;
+                task = task_;
+            }
+
+            (*task)(thread_index);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --running_workers_;
+            }
+            task_done_.notify_one();
+        }
+    }
+
+} // namespace graph_util
@@ -0,0 +1,71 @@
+#ifndef GRAPHSTORE_THREAD_POOL_HPP
+#define GRAPHSTORE_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graph_util {
+
+    ///
+    /// @brief ThreadPool keeps a fixed set of worker threads for the parallel algorithms, so that the threads are not
+    /// created again on every call. The calling thread takes part in every task as the thread with index 0.
+    ///
+    class ThreadPool {
+    public:
+        ///
+        /// @brief Creates the pool and starts thread_count - 1 worker threads.
+        /// @param thread_count The number of threads running every task, 0 means std::thread::hardware_concurrency()
+        ///
+        explicit ThreadPool(std::size_t thread_count);
+
+        /// Stops and joins the worker threads.
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /// @return The number of threads running every task, including the calling thread
+        std::size_t ThreadCount() const;
+
+        ///
+        /// @brief Runs the task on all threads of the pool and waits until every thread finishes it. Concurrent calls
+        /// are serialized.
+        ///
+        /// @param task Callable taking the index of the thread in [0, ThreadCount())
+        ///
+        void Run(const std::function<void(std::size_t)> &task);
+
+    private:
+        std::vector<std::thread> workers_;
+
+        // Serializes the Run calls.
+        std::mutex run_mutex_;
+
+        // Guards the fields below.
+        std::mutex mutex_;
+        std::condition_variable task_ready_;
+        std::condition_variable task_done_;
+
+        // The task of the current Run call.
+        const std::function<void(std::size_t)> *task_ = nullptr;
+
+        // Incremented for every task, the workers use it to tell a new task from the one they already ran.
+        std::uint64_t generation_ = 0;
+
+        // The number of workers that did not finish the current task yet.
+        std::size_t running_workers_ = 0;
+
+        bool stop_ = false;
+
+        // The loop of the worker thread with the passed index.
+        void workerLoop(std::size_t thread_index);
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_THREAD_POOL_HPP
@@ -24,6 +24,12 @@ namespace graph_util {
 
     }
 
+    void VertexState::ProcessVertexAdditions(const std::uint64_t count) {
+        for (std::uint64_t i = 0; i < count; ++i) {
+            ProcessVertexAddition();
+        }
+    }
+
     std::uint64_t OptimizedMemoryVertexState::GetDistance(std::uint64_t vertex_id) {
         const auto it = distances_.find(vertex_id);
         if (it != distances_.end()) {
@@ -58,38 +64,64 @@ namespace graph_util {
         parent_.clear();
     }
 
-
-    std::uint64_t OptimizedPerformanceVertexState::GetDistance(std::uint64_t vertex_id) {
-        return distances_[vertex_id];
+    MemoryFootprint OptimizedMemoryVertexState::Footprint() const {
+        MemoryFootprint footprint = HashMapFootprint(parent_);
+        footprint += HashMapFootprint(distances_);
+        return footprint;
     }
 
-    bool OptimizedPerformanceVertexState::SetDistance(std::uint64_t vertex_id, std::uint64_t value) {
-        distances_[vertex_id] = value;
-        affected_vertices_.push_back(vertex_id);
-        return true;
-    }
-
-    std::uint64_t OptimizedPerformanceVertexState::GetParent(std::uint64_t vertex_id) {
-        return parent_[vertex_id];
-    }
-
-    bool OptimizedPerformanceVertexState::SetParent(std::uint64_t vertex_id, std::uint64_t parent_vertex_id) {
-        parent_[vertex_id] = parent_vertex_id;
-        return true;
-    }
 
     void OptimizedPerformanceVertexState::Reset() {
         for (const auto vertex: affected_vertices_) {
             parent_[vertex] = 0;
-            distances_[vertex] = std::numeric_limits<std::uint64_t>::max();
+            distances_[vertex] = kNoVertex;
         }
         affected_vertices_.clear();
     }
 
     void OptimizedPerformanceVertexState::ProcessVertexAddition() {
         parent_.push_back(0);
-        distances_.push_back(std::numeric_limits<std::uint64_t>::max());
+        distances_.push_back(kNoVertex);
+    }
+
+    void OptimizedPerformanceVertexState::ProcessVertexAdditions(const std::uint64_t count) {
+        parent_.resize(parent_.size() + count, 0);
+        distances_.resize(distances_.size() + count, kNoVertex);
     }
 
+    MemoryFootprint OptimizedPerformanceVertexState::Footprint() const {
+        MemoryFootprint footprint;
+        footprint.AddBuffer<VertexId>(parent_.size(), parent_.capacity());
+        footprint.AddBuffer<VertexId>(distances_.size(), distances_.capacity());
+        footprint.AddBuffer<VertexId>(affected_vertices_.size(), affected_vertices_.capacity());
+        return footprint;
+    }
+
+    EpochVertexState::EpochVertexState(const std::uint32_t initial_epoch) : epoch_(initial_epoch) {
+    }
+
+    void EpochVertexState::Reset() {
+        if (++epoch_ != 0) {
+            return;
+        }
+
+        // The counter wrapped around, the entries stamped with the old epochs would look visited again.
+        for (auto &entry: entries_) {
+            entry.epoch = 0;
+        }
+        epoch_ = 1;
+    }
+
+    void EpochVertexState::ProcessVertexAddition() {
+        entries_.push_back({kNoVertex, kNoVertex, 0});
+    }
+
+    void EpochVertexState::ProcessVertexAdditions(const std::uint64_t count) {
+        entries_.resize(entries_.size() + count, {kNoVertex, kNoVertex, 0});
+    }
+
+    MemoryFootprint EpochVertexState::Footprint() const {
+        return MemoryFootprint().AddBuffer<Entry>(entries_.size(), entries_.capacity());
+    }
 
 } // namespace graph_util
\ No newline at end of file
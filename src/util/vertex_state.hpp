@@ -2,11 +2,14 @@
 #define GRAPHSTORE_VERTEX_STATE_HPP
 
 #include "graph_util.hpp"
+#include "memory_usage.hpp"
+#include <limits>
 #include <optional>
 #include <queue>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
+#include <variant>
 
 namespace graph_util {
 
@@ -58,6 +61,16 @@ namespace graph_util {
         virtual void Reset() = 0;
 
         virtual void ProcessVertexAddition();
+
+        ///
+        /// @brief Processes the addition of many vertices at once, the implementations holding per-vertex arrays
+        /// grow them in one allocation.
+        /// @param count The number of the added vertices
+        ///
+        virtual void ProcessVertexAdditions(std::uint64_t count);
+
+        /// @return The heap memory of the state, the memory held for the next queries after Reset is slack
+        virtual MemoryFootprint Footprint() const = 0;
     };
 
     ///
@@ -65,7 +78,7 @@ namespace graph_util {
     /// OptimizedMemoryVertexState does not allocate the additional memory for the vertices that are not affected and performs
     /// get and set operations in O(1) time.
     ///
-    class OptimizedMemoryVertexState : public VertexState {
+    class OptimizedMemoryVertexState final : public VertexState {
     public:
 
         std::uint64_t GetDistance(std::uint64_t vertex_id) override;
@@ -78,14 +91,17 @@ namespace graph_util {
 
         void Reset() override;
 
+        MemoryFootprint Footprint() const override;
+
     private:
-        // Parents map, vertex v is parent of the vertex parent[v].
-        std::unordered_map<std::uint64_t, std::uint64_t> parent_;
+        // Parents map, vertex v is parent of the vertex parent[v]. The maps count their memory, which depends on
+        // the number of the visited vertices and the bucket count kept by Reset.
+        CountedHashMap<std::uint64_t, std::uint64_t> parent_;
 
         // Distances map, distances[v] is the distance to the vertex v.
         // If the vertex v is not present in the distances map, this means that BFS could not find the path source_vertex
         // the source to it, or BFS algorithm exited before reaching the vertex v.
-        std::unordered_map<std::uint64_t, std::uint64_t> distances_;
+        CountedHashMap<std::uint64_t, std::uint64_t> distances_;
     };
 
     ///
@@ -96,35 +112,130 @@ namespace graph_util {
     ///
     /// @note In order to not reduce the performance, safety checks are not implemented in the class.
     /// When using this class the passed vertex_id-s should be valid.
-    class OptimizedPerformanceVertexState : public VertexState {
+    class OptimizedPerformanceVertexState final : public VertexState {
     public:
-        std::uint64_t GetDistance(std::uint64_t vertex_id) override;
+        std::uint64_t GetDistance(std::uint64_t vertex_id) override {
+            return WidenVertexId(distances_[vertex_id]);
+        }
 
-        bool SetDistance(std::uint64_t vertex_id, std::uint64_t value) override;
+        bool SetDistance(std::uint64_t vertex_id, std::uint64_t value) override {
+            distances_[vertex_id] = VertexId(value);
+            affected_vertices_.push_back(VertexId(vertex_id));
+            return true;
+        }
 
-        std::uint64_t GetParent(std::uint64_t vertex_id) override;
+        std::uint64_t GetParent(std::uint64_t vertex_id) override {
+            return parent_[vertex_id];
+        }
 
-        bool SetParent(std::uint64_t vertex_id, std::uint64_t parent_vertex_id) override;
+        bool SetParent(std::uint64_t vertex_id, std::uint64_t parent_vertex_id) override {
+            parent_[vertex_id] = VertexId(parent_vertex_id);
+            return true;
+        }
 
         void Reset() override;
 
         void ProcessVertexAddition() override;
 
+        void ProcessVertexAdditions(std::uint64_t count) override;
+
+        MemoryFootprint Footprint() const override;
+
     private:
 
         // Parents vector, vertex v is the parent of the vertex parent[v].
-        std::vector<std::uint64_t> parent_;
+        VertexIdVector parent_;
 
-        // Distances vector, distances[v] is the distance to the vertex v.
-        // If the distance is not calculated for the vertex v, it's set to max value of std::uint64_t
-        std::vector<std::uint64_t> distances_;
+        // Distances vector, distances[v] is the distance to the vertex v. A distance is shorter than the vertex count,
+        // so it's stored in the width of the vertex IDs. If the distance is not calculated for the vertex v, it's set
+        // to kNoVertex.
+        VertexIdVector distances_;
 
         // The indices, which were changed in the parent_ and distances_ vectors.
         // affected_vertices_ is used to quickly reset parent_ and distances_ vectors, by only iterating the indices
         // that were modified.
-        std::vector<std::uint64_t> affected_vertices_;
+        VertexIdVector affected_vertices_;
     };
 
+    ///
+    /// @brief EpochVertexState implements VertexState, stores the distances and the parents in one vector together with
+    /// the epoch of the query that set them. Every Reset starts a new epoch, and the entries stamped with an older
+    /// epoch are treated as not visited, so Reset takes O(1) time instead of rewriting the visited entries. The entries
+    /// are cleared only when the epoch counter wraps around. EpochVertexState has O(V) memory allocated all the time,
+    /// where V is the number of vertices in the graph. get and set operations have O(1) time complexity.
+    ///
+    /// @note In order to not reduce the performance, safety checks are not implemented in the class.
+    /// When using this class the passed vertex_id-s should be valid.
+    class EpochVertexState final : public VertexState {
+    public:
+        ///
+        /// @param initial_epoch The epoch of the first query, should not be 0. Starting close to the maximum value
+        /// makes the wraparound happen early.
+        ///
+        explicit EpochVertexState(std::uint32_t initial_epoch = 1);
+
+        std::uint64_t GetDistance(std::uint64_t vertex_id) override {
+            const Entry &entry = entries_[vertex_id];
+            return entry.epoch == epoch_ ? WidenVertexId(entry.distance) : std::numeric_limits<std::uint64_t>::max();
+        }
+
+        bool SetDistance(std::uint64_t vertex_id, std::uint64_t value) override {
+            touch(vertex_id).distance = VertexId(value);
+            return true;
+        }
+
+        std::uint64_t GetParent(std::uint64_t vertex_id) override {
+            const Entry &entry = entries_[vertex_id];
+            return entry.epoch == epoch_ ? WidenVertexId(entry.parent) : std::numeric_limits<std::uint64_t>::max();
+        }
+
+        bool SetParent(std::uint64_t vertex_id, std::uint64_t parent_vertex_id) override {
+            touch(vertex_id).parent = VertexId(parent_vertex_id);
+            return true;
+        }
+
+        void Reset() override;
+
+        void ProcessVertexAddition() override;
+
+        void ProcessVertexAdditions(std::uint64_t count) override;
+
+        MemoryFootprint Footprint() const override;
+
+    private:
+        // The state of one vertex, the distance and the parent are valid only if epoch matches the current epoch.
+        // Keeping the fields together lets the stamp check and the read share one cache line.
+        struct Entry {
+            VertexId distance;
+            VertexId parent;
+            std::uint32_t epoch;
+        };
+
+        // entries_[v] is the state of the vertex v.
+        std::vector<Entry> entries_;
+
+        // The epoch of the current query, 0 is never used so that the cleared entries are not visited.
+        std::uint32_t epoch_;
+
+        // Stamps the entry with the current epoch, the entry of a vertex not visited in the current query is reset.
+        Entry &touch(const std::uint64_t vertex_id) {
+            Entry &entry = entries_[vertex_id];
+            if (entry.epoch != epoch_) {
+                entry.epoch = epoch_;
+                entry.distance = kNoVertex;
+                entry.parent = kNoVertex;
+            }
+            return entry;
+        }
+    };
+
+    ///
+    /// @brief Any of the VertexState implementations. The implementations are final, so the searches that are
+    /// instantiated for the concrete alternative call the accessors directly and can inline them.
+    ///
+    using VertexStateVariant = std::variant<OptimizedPerformanceVertexState, OptimizedMemoryVertexState,
+            EpochVertexState>;
+
 } // namespace graph_util
 
 #endif //GRAPHSTORE_VERTEX_STATE_HPP
@@ -0,0 +1,202 @@
+#include "write_ahead_log.hpp"
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace graph_util {
+
+    namespace {
+
+        // The table of the reflected CRC-32 polynomial 0xEDB88320, as used by zlib and Ethernet.
+        std::array<std::uint32_t, 256> makeCrcTable() {
+            std::array<std::uint32_t, 256> table{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        std::uint32_t crc32(const char *data, const std::size_t size) {
+            static const std::array<std::uint32_t, 256> table = makeCrcTable();
+            std::uint32_t crc = 0xFFFFFFFF;
+            for (std::size_t i = 0; i < size; ++i) {
+                crc = table[(crc ^ std::uint8_t(data[i])) & 0xFF] ^ (crc >> 8);
+            }
+            return crc ^ 0xFFFFFFFF;
+        }
+
+        template<typename T>
+        void appendValue(std::vector<char> &buffer, const T value) {
+            const auto *bytes = reinterpret_cast<const char *>(&value);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+        }
+
+        template<typename T>
+        T readValue(const char *data) {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return value;
+        }
+
+    } // namespace
+
+    WriteAheadLog::WriteAheadLog(const std::string &path, const Recovery &recovery,
+                                 const std::uint64_t last_sequence_number,
+                                 const std::chrono::milliseconds flush_interval, const bool sync) :
+            fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644)),
+            flush_interval_(flush_interval),
+            sync_(sync),
+            last_sequence_number_(last_sequence_number),
+            flushed_sequence_number_(last_sequence_number) {
+        if (fd_ < 0) {
+            throw std::runtime_error("Failed to open the write-ahead log " + path + ".");
+        }
+        // Cut off the partially written record, the new records would not be readable after it.
+        if (::ftruncate(fd_, off_t(recovery.valid_size)) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("Failed to truncate the write-ahead log " + path + ".");
+        }
+
+        flusher_ = std::thread(&WriteAheadLog::flusherLoop, this);
+    }
+
+    WriteAheadLog::~WriteAheadLog() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        flush_requested_.notify_one();
+        flusher_.join();
+        ::close(fd_);
+    }
+
+    WriteAheadLog::Recovery WriteAheadLog::Replay(const std::string &path,
+                                                  const std::function<void(const Record &)> &visitor) {
+        Recovery recovery;
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return recovery;
+        }
+
+        std::vector<char> contents;
+        char frame[kFrameSize];
+        while (std::fread(frame, 1, kFrameSize, file) == kFrameSize) {
+            const auto size = readValue<std::uint32_t>(frame);
+            const auto checksum = readValue<std::uint32_t>(frame + sizeof(std::uint32_t));
+            if (size < kFixedContentsSize) {
+                break;
+            }
+            contents.resize(size);
+            if (std::fread(contents.data(), 1, size, file) != size || crc32(contents.data(), size) != checksum) {
+                break;
+            }
+
+            Record record;
+            const char *data = contents.data();
+            record.sequence_number = readValue<std::uint64_t>(data);
+            record.type = RecordType(readValue<std::uint8_t>(data + sizeof(std::uint64_t)));
+            record.vertex_id = readValue<std::uint64_t>(data + sizeof(std::uint64_t) + sizeof(std::uint8_t));
+            record.argument = readValue<std::uint64_t>(data + 2 * sizeof(std::uint64_t) + sizeof(std::uint8_t));
+            record.label.assign(data + kFixedContentsSize, size - kFixedContentsSize);
+            visitor(record);
+
+            recovery.last_sequence_number = record.sequence_number;
+            recovery.valid_size += kFrameSize + size;
+        }
+
+        std::fclose(file);
+        return recovery;
+    }
+
+    std::uint64_t WriteAheadLog::Append(const RecordType type, const std::uint64_t vertex_id,
+                                        const std::uint64_t argument, const Label &label) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::uint64_t sequence_number = ++last_sequence_number_;
+
+        // Reserve the frame, the checksum is computed over the contents once they are serialized.
+        const std::size_t frame_position = buffer_.size();
+        buffer_.resize(buffer_.size() + kFrameSize);
+        appendValue(buffer_, sequence_number);
+        appendValue(buffer_, std::uint8_t(type));
+        appendValue(buffer_, vertex_id);
+        appendValue(buffer_, argument);
+        buffer_.insert(buffer_.end(), label.begin(), label.end());
+
+        const auto size = std::uint32_t(buffer_.size() - frame_position - kFrameSize);
+        const std::uint32_t checksum = crc32(buffer_.data() + frame_position + kFrameSize, size);
+        std::memcpy(buffer_.data() + frame_position, &size, sizeof(size));
+        std::memcpy(buffer_.data() + frame_position + sizeof(size), &checksum, sizeof(checksum));
+
+        if (buffer_.size() >= kFlushBytes && !write_requested_) {
+            write_requested_ = true;
+            flush_requested_.notify_one();
+        }
+        return sequence_number;
+    }
+
+    std::uint64_t WriteAheadLog::LastSequenceNumber() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_sequence_number_;
+    }
+
+    void WriteAheadLog::Sync() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const std::uint64_t sequence_number = last_sequence_number_;
+        if (flushed_sequence_number_ < sequence_number) {
+            write_requested_ = true;
+            flush_requested_.notify_one();
+            flushed_.wait(lock, [this, sequence_number]() {
+                return failed_ || flushed_sequence_number_ >= sequence_number;
+            });
+        }
+        if (failed_) {
+            throw std::runtime_error("Failed to write the write-ahead log.");
+        }
+    }
+
+    void WriteAheadLog::flusherLoop() {
+        std::vector<char> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            flush_requested_.wait_for(lock, flush_interval_, [this]() { return stop_ || write_requested_; });
+            write_requested_ = false;
+
+            if (!buffer_.empty()) {
+                // Take the buffer, so that the appends continue while the batch is written.
+                batch.swap(buffer_);
+                const std::uint64_t sequence_number = last_sequence_number_;
+                lock.unlock();
+
+                bool written = true;
+                for (std::size_t offset = 0; written && offset < batch.size();) {
+                    const ssize_t count = ::write(fd_, batch.data() + offset, batch.size() - offset);
+                    if (count < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    written = count > 0;
+                    offset += written ? std::size_t(count) : 0;
+                }
+                written = written && (!sync_ || ::fdatasync(fd_) == 0);
+                batch.clear();
+
+                lock.lock();
+                failed_ = failed_ || !written;
+                flushed_sequence_number_ = sequence_number;
+                flushed_.notify_all();
+            }
+
+            if (stop_ && buffer_.empty()) {
+                return;
+            }
+        }
+    }
+
+} // namespace graph_util
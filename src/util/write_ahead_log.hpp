@@ -0,0 +1,146 @@
+#ifndef GRAPHSTORE_WRITE_AHEAD_LOG_HPP
+#define GRAPHSTORE_WRITE_AHEAD_LOG_HPP
+
+#include "graph_util.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace graph_util {
+
+    ///
+    /// @brief WriteAheadLog is an append-only log of the graph modifications with group commit.
+    ///
+    /// Append only serializes the record into a memory buffer. A background thread writes the buffered records to the
+    /// file once per flush interval, or earlier if the buffer grows large or Sync is called, and syncs the file after
+    /// every write if requested. All records appended between two flushes share one write and one sync.
+    ///
+    /// Every record is framed by its length and a CRC-32 checksum of its contents. A crash may leave a partially
+    /// written record at the end of the file, Replay stops at the first record that is incomplete or does not match
+    /// its checksum, and the log opened for appending cuts the file there.
+    ///
+    class WriteAheadLog {
+    public:
+        /// The types of the logged modifications
+        enum class RecordType : std::uint8_t {
+            CREATE_VERTEX = 1,
+            CREATE_EDGE = 2,
+            INTERN_LABEL = 3,
+            ADD_LABEL = 4,
+            REMOVE_LABEL = 5
+        };
+
+        /// One logged modification
+        struct Record {
+            /// The position of the record in the log, the records are numbered from 1
+            std::uint64_t sequence_number;
+            RecordType type;
+            /// The created vertex, the origin of the created edge, or the vertex of the label modification
+            std::uint64_t vertex_id;
+            /// The destination of the created edge, or the label ID of the label modification
+            std::uint64_t argument;
+            /// The interned label
+            Label label;
+        };
+
+        /// The valid part of the log file, as found by Replay
+        struct Recovery {
+            /// The sequence number of the last valid record, 0 if there is none
+            std::uint64_t last_sequence_number = 0;
+            /// The size of the valid records in bytes, the rest of the file is cut off
+            std::uint64_t valid_size = 0;
+        };
+
+        ///
+        /// @brief Opens the log file for appending, creates it if it does not exist, and starts the flusher thread.
+        ///
+        /// @param path The path of the log file
+        /// @param recovery The valid part of the file returned by Replay, the file is truncated to its size
+        /// @param last_sequence_number The sequence number after which the appended records are numbered
+        /// @param flush_interval The longest time between the Append and the write of the record
+        /// @param sync Sync the file to the storage after every write, otherwise it's only written to the OS
+        /// @throws std::runtime_error if the file can not be opened
+        ///
+        WriteAheadLog(const std::string &path, const Recovery &recovery, std::uint64_t last_sequence_number,
+                      std::chrono::milliseconds flush_interval, bool sync);
+
+        /// Writes the remaining records and stops the flusher thread.
+        ~WriteAheadLog();
+
+        WriteAheadLog(const WriteAheadLog &) = delete;
+
+        WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+        ///
+        /// @brief Reads the valid records of the log file in order.
+        ///
+        /// @param path The path of the log file, the missing file is treated as empty
+        /// @param visitor Callable taking each valid record
+        /// @return The valid part of the file
+        ///
+        static Recovery Replay(const std::string &path, const std::function<void(const Record &)> &visitor);
+
+        ///
+        /// @brief Appends the record to the buffer, the record is written by the flusher thread.
+        ///
+        /// @param type The type of the modification
+        /// @param vertex_id See Record::vertex_id
+        /// @param argument See Record::argument
+        /// @param label See Record::label
+        /// @return The sequence number of the record
+        ///
+        std::uint64_t Append(RecordType type, std::uint64_t vertex_id, std::uint64_t argument = 0,
+                             const Label &label = Label());
+
+        /// @return The sequence number of the last appended record
+        std::uint64_t LastSequenceNumber() const;
+
+        ///
+        /// @brief Waits until all records appended before the call are written and, if requested, synced.
+        /// @throws std::runtime_error if writing the log failed
+        ///
+        void Sync();
+
+    private:
+        // The buffer size that triggers a write before the flush interval passes.
+        static constexpr std::size_t kFlushBytes = 1 << 20;
+
+        // The bytes before the record contents: the length of the contents and their checksum.
+        static constexpr std::size_t kFrameSize = 2 * sizeof(std::uint32_t);
+
+        // The contents without the label: the sequence number, the type, the vertex ID and the argument.
+        static constexpr std::size_t kFixedContentsSize = 3 * sizeof(std::uint64_t) + sizeof(std::uint8_t);
+
+        int fd_;
+        const std::chrono::milliseconds flush_interval_;
+        const bool sync_;
+
+        mutable std::mutex mutex_;
+        // Notifies the flusher about a requested write.
+        std::condition_variable flush_requested_;
+        // Notifies Sync about a finished write.
+        std::condition_variable flushed_;
+
+        // The serialized records waiting for the flusher.
+        std::vector<char> buffer_;
+        std::uint64_t last_sequence_number_;
+        // The sequence number of the last written record.
+        std::uint64_t flushed_sequence_number_;
+        bool write_requested_ = false;
+        bool failed_ = false;
+        bool stop_ = false;
+
+        std::thread flusher_;
+
+        // Writes the buffer once per flush interval or on request, until the log is destroyed.
+        void flusherLoop();
+    };
+
+} // namespace graph_util
+
+#endif //GRAPHSTORE_WRITE_AHEAD_LOG_HPP
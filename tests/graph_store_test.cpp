@@ -1,13 +1,22 @@
 #include <gtest/gtest.h>
 #include "graph_store.hpp"
+#include "util/graph_generator.hpp"
 #include "util/graph_util.hpp"
+#include "util/snapshot_file.hpp"
 
 #include <chrono>
+#include <limits>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
 #include <algorithm>
+#include <cstdio>
+#include <random>
+#include <unistd.h>
 
 constexpr std::uint64_t inf = 1e+9;
 using adj_matrix = std::vector<std::vector<std::uint64_t>>;
@@ -36,17 +45,8 @@ adj_matrix FloydWarshall(const std::uint64_t vertex_count, const std::vector<gra
 }
 
 std::vector<graph_util::Edge> GenerateRandomGraph(std::uint64_t vertex_count, std::uint64_t edge_count) {
-    std::vector<graph_util::Edge> edges;
-
-    for (auto i = 0; i < edge_count; ++i) {
-        graph_util::Edge edge{0,0};
-        // Multiple edges are allowed according to the Graph Store implementation.
-        edge.source_vertex = std::rand() % vertex_count;
-        edge.destination_vertex = std::rand() % vertex_count;
-        edges.push_back(edge);
-    }
-
-    return edges;
+    // Multiple edges are allowed according to the Graph Store implementation.
+    return graph_util::GenerateErdosRenyiGraph(vertex_count, edge_count, std::rand());
 }
 
 struct GraphStoreTestParam {
@@ -161,12 +161,49 @@ TEST_P(GraphStorePTest, TestShortestPathOptimizedPerformance) {
     EXPECT_EQ(gs.ShortestPath(param.src_vertex_id, param.dst_vertex_id, param.label).value_or(empty_path), param.want);
 }
 
-class GraphStoreTestWithDifferentStrategies : public ::testing::TestWithParam<graph_store::GraphStore::Strategy> {
+// Every combination of the vertex state strategy, the adjacency layout, the label storage and the search algorithm.
+std::vector<graph_store::GraphStore::Options> AllConfigurations() {
+    std::vector<graph_store::GraphStore::Options> configurations;
+    for (const auto strategy: {graph_store::GraphStore::Strategy::OPTIMIZED_PERFORMANCE,
+                               graph_store::GraphStore::Strategy::OPTIMIZED_MEMORY,
+                               graph_store::GraphStore::Strategy::OPTIMIZED_RESET}) {
+        for (const auto layout: {graph_store::GraphStore::AdjacencyLayout::ADJACENCY_LIST,
+                                 graph_store::GraphStore::AdjacencyLayout::CSR,
+                                 graph_store::GraphStore::AdjacencyLayout::DELTA_CSR,
+                                 graph_store::GraphStore::AdjacencyLayout::CONCURRENT,
+                                 graph_store::GraphStore::AdjacencyLayout::COMPRESSED_CSR}) {
+            for (const bool label_masks: {false, true}) {
+                if (layout == graph_store::GraphStore::AdjacencyLayout::CONCURRENT && label_masks) {
+                    continue;
+                }
+                for (const auto search: {graph_store::GraphStore::SearchAlgorithm::BFS,
+                                         graph_store::GraphStore::SearchAlgorithm::BIDIRECTIONAL_BFS,
+                                         graph_store::GraphStore::SearchAlgorithm::DIRECTION_OPTIMIZING_BFS,
+                                         graph_store::GraphStore::SearchAlgorithm::PARALLEL_BFS}) {
+                    graph_store::GraphStore::Options options;
+                    options.strategy = strategy;
+                    options.layout = layout;
+                    // Merge the delta buffers often, so that the tests cover the graphs in the middle of the merge.
+                    options.delta_merge_threshold = 8;
+                    options.label_masks = label_masks;
+                    options.search = search;
+                    options.store_in_edges = search == graph_store::GraphStore::SearchAlgorithm::BIDIRECTIONAL_BFS ||
+                                             search == graph_store::GraphStore::SearchAlgorithm::DIRECTION_OPTIMIZING_BFS;
+                    // More threads than the test graphs need, so that the threads race for the same vertices.
+                    options.thread_count = 4;
+                    configurations.push_back(options);
+                }
+            }
+        }
+    }
+    return configurations;
+}
+
+class GraphStoreTestWithDifferentStrategies : public ::testing::TestWithParam<graph_store::GraphStore::Options> {
 };
 
 INSTANTIATE_TEST_SUITE_P(GraphStoreTestSuite, GraphStoreTestWithDifferentStrategies,
-                         ::testing::Values(graph_store::GraphStore::Strategy::OPTIMIZED_PERFORMANCE,
-                                           graph_store::GraphStore::Strategy::OPTIMIZED_MEMORY));
+                         ::testing::ValuesIn(AllConfigurations()));
 
 
 TEST_P(GraphStoreTestWithDifferentStrategies, SingleVertexNoLabel) {
@@ -207,6 +244,65 @@ TEST_P(GraphStoreTestWithDifferentStrategies, SameLabelMultipleTimes) {
     ASSERT_FALSE(gs.ShortestPath(id, id, label).has_value());
 }
 
+TEST_P(GraphStoreTestWithDifferentStrategies, InternedLabels) {
+    graph_store::GraphStore gs(GetParam());
+    auto id1 = gs.CreateVertex();
+    auto id2 = gs.CreateVertex();
+    gs.CreateEdge(id1, id2);
+
+    auto label_id = gs.InternLabel("testLabel");
+    EXPECT_EQ(gs.InternLabel("testLabel"), label_id);
+    EXPECT_NE(gs.InternLabel("otherLabel"), label_id);
+
+    // Interning alone does not set the label.
+    ASSERT_FALSE(gs.ShortestPath(id1, id1, label_id).has_value());
+
+    EXPECT_TRUE(gs.AddLabel(id1, label_id));
+    EXPECT_TRUE(gs.AddLabel(id2, "testLabel"));
+    auto path = gs.ShortestPath(id1, id2, label_id);
+    ASSERT_TRUE(path.has_value());
+    graph_util::Path want = {1, {id1, id2}};
+    ASSERT_EQ(path.value(), want);
+    ASSERT_EQ(gs.ShortestPath(id1, id2, "testLabel"), path);
+
+    EXPECT_TRUE(gs.RemoveLabel(id2, label_id));
+    ASSERT_FALSE(gs.ShortestPath(id1, id2, "testLabel").has_value());
+
+    // Unknown label IDs and vertices are rejected.
+    EXPECT_FALSE(gs.AddLabel(id1, label_id + 100));
+    EXPECT_FALSE(gs.AddLabel(id2 + 1, label_id));
+    EXPECT_FALSE(gs.RemoveLabel(id2 + 1, label_id));
+    EXPECT_TRUE(gs.RemoveLabel(id1, label_id + 100));
+    ASSERT_FALSE(gs.ShortestPath(id1, id1, label_id + 100).has_value());
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, MoreLabelsThanMaskWidth) {
+    const std::uint64_t label_count = 100;
+    graph_store::GraphStore gs(GetParam());
+    auto id1 = gs.CreateVertex();
+    auto id2 = gs.CreateVertex();
+    gs.CreateEdge(id1, id2);
+
+    // Labels with odd IDs are set to both vertices, the ones with even IDs only to the first vertex.
+    for (std::uint64_t i = 0; i < label_count; ++i) {
+        EXPECT_TRUE(gs.AddLabel(id1, std::to_string(i)));
+        if (i % 2 == 1) {
+            EXPECT_TRUE(gs.AddLabel(id2, std::to_string(i)));
+        }
+    }
+
+    for (std::uint64_t i = 0; i < label_count; ++i) {
+        EXPECT_EQ(gs.ShortestPath(id1, id2, std::to_string(i)).has_value(), i % 2 == 1);
+    }
+
+    for (std::uint64_t i = 0; i < label_count; i += 3) {
+        EXPECT_TRUE(gs.RemoveLabel(id1, std::to_string(i)));
+    }
+    for (std::uint64_t i = 0; i < label_count; ++i) {
+        EXPECT_EQ(gs.ShortestPath(id1, id2, std::to_string(i)).has_value(), i % 2 == 1 && i % 3 != 0);
+    }
+}
+
 TEST_P(GraphStoreTestWithDifferentStrategies, EmptyTwoVertexGraph) {
     graph_store::GraphStore gs(GetParam());
     std::string label = "testLabel";
@@ -268,6 +364,35 @@ TEST_P(GraphStoreTestWithDifferentStrategies, TwoVertexGraphWithMultipleLabels)
     }
 }
 
+TEST_P(GraphStoreTestWithDifferentStrategies, CreateEdgeAfterBulkLoad) {
+    std::string label = "testLabel";
+    graph_store::GraphStore gs(4, {{label, {0, 1, 2, 3}}}, {{0, 1}, {2, 3}}, GetParam());
+
+    ASSERT_FALSE(gs.ShortestPath(0, 3, label).has_value());
+    EXPECT_FALSE(gs.CreateEdge(1, 4));
+
+    // Connect the two components, the edge lands in the middle of the CSR targets array.
+    EXPECT_TRUE(gs.CreateEdge(1, 2));
+    auto path = gs.ShortestPath(0, 3, label);
+    ASSERT_TRUE(path.has_value());
+    graph_util::Path want = {3, {0, 1, 2, 3}};
+    ASSERT_EQ(path.value(), want);
+
+    // Edges of the new vertex go to the end of the adjacency.
+    auto id = gs.CreateVertex();
+    gs.AddLabel(id, label);
+    EXPECT_TRUE(gs.CreateEdge(id, 0));
+    EXPECT_TRUE(gs.CreateEdge(3, id));
+    path = gs.ShortestPath(2, 1, label);
+    ASSERT_TRUE(path.has_value());
+    want = {4, {2, 3, id, 0, 1}};
+    ASSERT_EQ(path.value(), want);
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, BulkLoadWithInvalidEdge) {
+    EXPECT_THROW(graph_store::GraphStore(2, {}, {{0, 2}}, GetParam()), std::invalid_argument);
+}
+
 TEST_P(GraphStoreTestWithDifferentStrategies, RandomGraphsWithOneLabel) {
     std::uint64_t graph_count = 100;
     while (graph_count--) {
@@ -363,43 +488,1408 @@ TEST_P(GraphStoreTestWithDifferentStrategies, RandomGraphsWithMultipleLabels) {
     }
 }
 
-// Performance test on random graph with 10^5 vertices, and 10^6 edges.
-TEST_P(GraphStoreTestWithDifferentStrategies, PerFormanceTest) {
-    const std::uint64_t vertex_count = 100000;
-    const std::uint64_t edge_count = 1000000;
-    const std::uint64_t label_count = 10;
-    const std::uint64_t label_length = 1000;
-    const std::uint64_t queries = 100;
+// Skewed, deep and clustered graphs with skewed and structure-correlated labels.
+TEST_P(GraphStoreTestWithDifferentStrategies, GeneratedGraphsWithGeneratedLabels) {
+    const std::vector<std::pair<std::uint64_t, std::vector<graph_util::Edge>>> graphs = {
+            {32, graph_util::GenerateRmatGraph(5, 96, {}, 1)},
+            {27, graph_util::GenerateKroneckerGraph({{0.5, 0.2, 0.1}, {0.1, 0.3, 0}, {0.2, 0, 0.4}}, 3, 80, 2)},
+            {30, graph_util::GenerateGridGraph(5, 6)},
+            {25, graph_util::GenerateChainGraph(25, false)},
+            {20, graph_util::GenerateStarGraph(20)},
+            {30, graph_util::GenerateErdosRenyiGraph(30, 60, 3)}};
+    for (const auto &[vertex_count, edges]: graphs) {
+        for (auto label_to_vertices: {graph_util::GenerateUniformLabels(vertex_count, 3, 2, 4),
+                                      graph_util::GenerateZipfianLabels(vertex_count, 4, 2, 1.5, 5),
+                                      graph_util::GenerateCommunityLabels(vertex_count, edges, 3, 0.1, 6)}) {
+            graph_store::GraphStore gs(vertex_count, label_to_vertices, edges, GetParam());
+            for (const auto &[label, vertices]: label_to_vertices) {
+                std::vector<graph_util::Edge> labelled_edges;
+                for (const auto &edge: edges) {
+                    if (vertices.count(edge.source_vertex) && vertices.count(edge.destination_vertex)) {
+                        labelled_edges.push_back(edge);
+                    }
+                }
+                auto want_dis_matrix = FloydWarshall(vertex_count, labelled_edges);
+                adj_matrix got_dis_matrix(vertex_count, std::vector<std::uint64_t>(vertex_count, inf));
+                for (std::uint64_t i = 0; i < vertex_count; ++i) {
+                    if (vertices.count(i) == 0) {
+                        want_dis_matrix[i][i] = inf;
+                    }
+                    for (std::uint64_t j = 0; j < vertex_count; ++j) {
+                        auto path = gs.ShortestPath(i, j, label);
+                        if (path.has_value()) {
+                            got_dis_matrix[i][j] = path->length;
+                        }
+                    }
+                }
+                ASSERT_EQ(got_dis_matrix, want_dis_matrix);
+            }
+        }
+    }
+}
 
-    auto start_time = std::chrono::system_clock::now();
+TEST_P(GraphStoreTestWithDifferentStrategies, ShortestPathWithStats) {
+    // The chain 0 -> 1 -> ... -> 9, every vertex of it also points to the unlabelled vertex 10.
+    const std::uint64_t vertex_count = 11;
+    auto edges = graph_util::GenerateChainGraph(10, false);
+    for (std::uint64_t v = 0; v < 10; ++v) {
+        edges.push_back({v, 10});
+    }
+    std::string label = "testLabel";
+    graph_util::VertexSet labelled;
+    for (std::uint64_t v = 0; v < 10; ++v) {
+        labelled.insert(v);
+    }
+    graph_store::GraphStore gs(vertex_count, {{label, labelled}}, edges, GetParam());
 
-    graph_store::GraphStore gs(GetParam());
+    graph_util::QueryStats stats;
+    const auto path = gs.ShortestPath(0, 9, label, stats);
+    ASSERT_EQ(path, gs.ShortestPath(0, 9, label));
+    ASSERT_TRUE(path.has_value());
+    EXPECT_EQ(path->length, 9);
+    EXPECT_GE(stats.level_reached, 9);
+    EXPECT_LE(stats.level_reached, vertex_count);
+    EXPECT_GE(stats.touched_vertices, 10);
+    EXPECT_LE(stats.touched_vertices, vertex_count + 1);
+    EXPECT_GT(stats.vertices_dequeued, 0);
+    EXPECT_GE(stats.edges_scanned, 9);
+    EXPECT_GE(stats.label_rejections, 1);
+    EXPECT_GT(stats.search_time.count(), 0);
+    if (GetParam().search == graph_store::GraphStore::SearchAlgorithm::BFS) {
+        // The vertices 0 to 8 are dequeued, the vertex 8 stops at the edge to the destination before the one to 10.
+        EXPECT_EQ(stats.level_reached, 9);
+        EXPECT_EQ(stats.vertices_dequeued, 9);
+        EXPECT_EQ(stats.edges_scanned, 17);
+        EXPECT_EQ(stats.label_rejections, 8);
+        EXPECT_EQ(stats.touched_vertices, 10);
+    }
 
-    for (auto i = 0; i < vertex_count; ++i) {
-        gs.CreateVertex();
+    // The statistics of the query without the label are cleared.
+    EXPECT_FALSE(gs.ShortestPath(0, 9, "missingLabel", stats).has_value());
+    EXPECT_EQ(stats.edges_scanned, 0);
+    EXPECT_EQ(stats.touched_vertices, 0);
+    EXPECT_FALSE(gs.ShortestPath(0, 10, label, stats).has_value());
+    EXPECT_EQ(stats.edges_scanned, 0);
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, MetricsCountOperations) {
+    std::string label = "testLabel";
+    graph_store::GraphStore gs(4, {{label, {0, 1, 2}}}, graph_util::GenerateChainGraph(4, false), GetParam());
+
+    // The bulk load is not counted.
+    auto metrics = gs.Metrics();
+    for (const auto &operation: metrics.operations) {
+        EXPECT_EQ(operation.count, 0);
+    }
+    EXPECT_EQ(metrics.vertex_count, 4);
+    EXPECT_EQ(metrics.edge_count, 3);
+    EXPECT_EQ(metrics.label_count, 1);
+
+    const auto vertex = gs.CreateVertex();
+    EXPECT_TRUE(gs.CreateEdge(2, vertex));
+    EXPECT_FALSE(gs.CreateEdge(2, vertex + 1));
+    EXPECT_TRUE(gs.AddLabel(vertex, label));
+    EXPECT_TRUE(gs.AddLabel(3, gs.InternLabel(label)));
+    EXPECT_TRUE(gs.RemoveLabel(3, label));
+    graph_util::QueryStats stats;
+    EXPECT_TRUE(gs.ShortestPath(0, vertex, label).has_value());
+    EXPECT_TRUE(gs.ShortestPath(0, vertex, gs.InternLabel(label), stats).has_value());
+    EXPECT_FALSE(gs.ShortestPath(0, vertex, "missingLabel").has_value());
+    if (GetParam().layout == graph_store::GraphStore::AdjacencyLayout::CONCURRENT) {
+        EXPECT_FALSE(gs.ShortestPath(0, 3, label).has_value());
+    } else {
+        EXPECT_FALSE(gs.Snapshot()->ShortestPath(0, 3, label).has_value());
     }
+    // A batch is one call, its queries are not counted as ShortestPath calls.
+    EXPECT_EQ(gs.ShortestPathBatch({{0, vertex, label}, {0, 3, label}}).size(), 2);
+
+    metrics = gs.Metrics();
+    EXPECT_EQ(metrics[graph_util::Operation::CREATE_VERTEX].count, 1);
+    EXPECT_EQ(metrics[graph_util::Operation::CREATE_EDGE].count, 2);
+    EXPECT_EQ(metrics[graph_util::Operation::ADD_LABEL].count, 2);
+    EXPECT_EQ(metrics[graph_util::Operation::REMOVE_LABEL].count, 1);
+    EXPECT_EQ(metrics[graph_util::Operation::SHORTEST_PATH].count, 4);
+    EXPECT_EQ(metrics[graph_util::Operation::SHORTEST_PATH_BATCH].count, 1);
+    for (const auto &operation: metrics.operations) {
+        std::uint64_t bucket_total = 0;
+        for (const auto count: operation.buckets) {
+            bucket_total += count;
+        }
+        EXPECT_EQ(bucket_total, operation.count);
+        EXPECT_LE(operation.Percentile(0.5), operation.Percentile(1));
+    }
+    EXPECT_EQ(metrics.vertex_count, 5);
+    EXPECT_EQ(metrics.edge_count, 4);
+    EXPECT_EQ(metrics.label_count, 1);
+
+    std::unordered_map<std::string, std::uint64_t> memory_bytes(metrics.memory_bytes.begin(),
+                                                                  metrics.memory_bytes.end());
+    const auto usage = gs.MemoryUsage();
+    EXPECT_EQ(memory_bytes.size(), 4);
+    EXPECT_EQ(memory_bytes["adjacency"], usage.adjacency);
+    EXPECT_EQ(memory_bytes["label_index"], usage.label_index);
+    EXPECT_EQ(memory_bytes["vertex_state"], usage.vertex_state);
+    EXPECT_EQ(memory_bytes["slack"], usage.slack);
+
+    const std::string text = graph_util::ToPrometheusText(metrics);
+    EXPECT_NE(text.find("graph_store_operations_total{operation=\"shortest_path\"} 4\n"), std::string::npos);
+    EXPECT_NE(text.find("graph_store_operations_total{operation=\"shortest_path_batch\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("graph_store_operation_duration_seconds_count{operation=\"create_edge\"} 2\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("graph_store_vertices 5\n"), std::string::npos);
+    EXPECT_NE(text.find("graph_store_memory_bytes{structure=\"adjacency\"} " +
+                        std::to_string(memory_bytes["adjacency"]) + "\n"), std::string::npos);
+}
 
-    for (auto i = 0; i < edge_count; ++i) {
-        gs.CreateEdge(std::rand() % vertex_count, std::rand() % vertex_count);
+TEST_P(GraphStoreTestWithDifferentStrategies, MemoryUsageBreakdown) {
+    const std::uint64_t vertex_count = 1000;
+    const auto edges = graph_util::GenerateErdosRenyiGraph(vertex_count, 4 * vertex_count, 7);
+    const auto labels = graph_util::GenerateUniformLabels(vertex_count, 4, 2, 7);
+    graph_store::GraphStore gs(vertex_count, labels, edges, GetParam());
+
+    // No query ran yet, so there is no search state.
+    auto usage = gs.MemoryUsage();
+    const std::uint64_t adjacency_copies = GetParam().store_in_edges ? 2 : 1;
+    if (GetParam().layout != graph_store::GraphStore::AdjacencyLayout::COMPRESSED_CSR) {
+        EXPECT_GE(usage.adjacency, adjacency_copies * edges.size() * sizeof(graph_util::VertexId));
     }
+    EXPECT_LE(usage.adjacency, adjacency_copies * edges.size() * 4 * sizeof(std::uint64_t) + (1 << 20));
+    EXPECT_GT(usage.label_index, 0);
+    EXPECT_EQ(usage.vertex_state, 0);
+    EXPECT_EQ(usage.Total(), usage.adjacency + usage.label_index + usage.vertex_state + usage.slack);
+
+    // The idle state is kept for the next query.
+    gs.ShortestPath(0, vertex_count - 1, graph_util::GeneratedLabel(0));
+    usage = gs.MemoryUsage();
+    EXPECT_GT(usage.vertex_state, 0);
+    if (GetParam().search == graph_store::GraphStore::SearchAlgorithm::PARALLEL_BFS) {
+        EXPECT_GE(usage.vertex_state, vertex_count * sizeof(graph_util::VertexId));
+    } else if (GetParam().strategy != graph_store::GraphStore::Strategy::OPTIMIZED_MEMORY) {
+        EXPECT_GE(usage.vertex_state, 2 * vertex_count * sizeof(graph_util::VertexId));
+    }
+
+    // The memory of the labels grows with their vertices.
+    const auto label_index = usage.label_index;
+    const auto label_id = gs.InternLabel("everyVertex");
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        gs.AddLabel(v, label_id);
+    }
+    EXPECT_GT(gs.MemoryUsage().label_index, label_index);
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, SparseLabelOnLargeGraph) {
+    const std::uint64_t vertex_count = 1 << 18;
+    std::vector<graph_util::Edge> edges;
+    for (std::uint64_t i = 0; i + 1 < vertex_count; ++i) {
+        edges.push_back({i, i + 1});
+    }
+    // Shortcut from the first chunk of 2^16 vertices to the last one.
+    edges.push_back({100, vertex_count - 10});
 
-    std::vector<std::string> labels(label_count);
-    for (auto i = 0; i < label_count; ++i) {
-        for (auto j = 0; j < label_length; ++j) {
-            labels[i] += char(i + '0');
+    std::string label = "sparseLabel";
+    graph_util::VertexSet labelled = {100, vertex_count - 10, vertex_count - 9, vertex_count - 8};
+    for (std::uint64_t i = 0; i <= 100; ++i) {
+        labelled.insert(i);
+    }
+    graph_store::GraphStore gs(vertex_count, {{label, labelled}}, edges, GetParam());
+
+    auto path = gs.ShortestPath(98, vertex_count - 8, label);
+    ASSERT_TRUE(path.has_value());
+    graph_util::Path want = {5, {98, 99, 100, vertex_count - 10, vertex_count - 9, vertex_count - 8}};
+    ASSERT_EQ(path.value(), want);
+
+    EXPECT_TRUE(gs.RemoveLabel(vertex_count - 9, label));
+    ASSERT_FALSE(gs.ShortestPath(98, vertex_count - 8, label).has_value());
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, BatchMatchesSingleQueries) {
+    const std::uint64_t vertex_count = 300;
+    const auto edges = GenerateRandomGraph(vertex_count, 3 * vertex_count);
+
+    // The first label is set to most vertices, the second one to a few.
+    std::unordered_map<std::string, graph_util::VertexSet> label_to_vertices;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        if (v % 5 != 0) {
+            label_to_vertices["common"].insert(v);
+        }
+        if (v % 3 == 0) {
+            label_to_vertices["rare"].insert(v);
+        }
+    }
+    graph_store::GraphStore gs(vertex_count, label_to_vertices, edges, GetParam());
+
+    // More queries per label than fit into one sweep, plus the queries without answers.
+    std::vector<graph_store::GraphStore::Query> queries;
+    for (int i = 0; i < 150; ++i) {
+        queries.push_back({std::rand() % vertex_count, std::rand() % vertex_count, i % 3 == 0 ? "rare" : "common"});
+    }
+    queries.push_back({7, 7, "common"});
+    queries.push_back({0, vertex_count, "common"});
+    queries.push_back({1, 2, "unknownLabel"});
+
+    const auto got = gs.ShortestPathBatch(queries);
+    ASSERT_EQ(got.size(), queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        const auto &query = queries[i];
+        const auto want = gs.ShortestPath(query.src_vertex_id, query.dst_vertex_id, query.label);
+        ASSERT_EQ(got[i].has_value(), want.has_value());
+        if (!got[i].has_value()) {
+            continue;
+        }
+
+        // Any of the shortest paths may be returned, check that it is a valid one of the same length.
+        ASSERT_EQ(got[i]->length, want->length);
+        ASSERT_EQ(got[i]->vertices.size(), got[i]->length + 1);
+        ASSERT_EQ(got[i]->vertices.front(), query.src_vertex_id);
+        ASSERT_EQ(got[i]->vertices.back(), query.dst_vertex_id);
+        for (std::uint64_t j = 0; j < got[i]->length; ++j) {
+            const graph_util::Edge edge{got[i]->vertices[j], got[i]->vertices[j + 1]};
+            ASSERT_TRUE(label_to_vertices[query.label].count(edge.destination_vertex) != 0);
+            ASSERT_TRUE(std::any_of(edges.begin(), edges.end(), [&edge](const graph_util::Edge &e) {
+                return e.source_vertex == edge.source_vertex && e.destination_vertex == edge.destination_vertex;
+            }));
         }
-        for (auto j = 0; j < vertex_count; ++j) {
-            gs.AddLabel(j, labels[i]);
+    }
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, ConcurrentReaders) {
+    const std::uint64_t vertex_count = 200;
+    const auto edges = GenerateRandomGraph(vertex_count, 3 * vertex_count);
+
+    std::string label = "testLabel";
+    graph_util::VertexSet labelled;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        if (v % 7 != 0) {
+            labelled.insert(v);
         }
     }
+    const graph_store::GraphStore gs(vertex_count, {{label, labelled}}, edges, GetParam());
+
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> queries;
+    std::vector<std::optional<std::uint64_t>> want;
+    for (int i = 0; i < 100; ++i) {
+        queries.emplace_back(std::rand() % vertex_count, std::rand() % vertex_count);
+        const auto path = gs.ShortestPath(queries.back().first, queries.back().second, label);
+        want.push_back(path.has_value() ? std::optional<std::uint64_t>(path->length) : std::nullopt);
+    }
 
-    for (auto i = 0; i < queries; ++i) {
-        std::uint64_t src_vertex = std::rand() % vertex_count;
-        std::uint64_t dst_vertex = std::rand() % vertex_count;
-        auto path = gs.ShortestPath(src_vertex, dst_vertex, labels[std::rand() % label_count]);
+    // Every reader runs all queries, so that the readers search the same vertices at the same time.
+    std::vector<std::vector<std::optional<std::uint64_t>>> got(4);
+    std::vector<std::thread> readers;
+    for (auto &reader_got: got) {
+        readers.emplace_back([&gs, &queries, &label, &reader_got]() {
+            for (const auto &[src, dst]: queries) {
+                const auto path = gs.ShortestPath(src, dst, label);
+                reader_got.push_back(path.has_value() ? std::optional<std::uint64_t>(path->length) : std::nullopt);
+            }
+        });
+    }
+    for (auto &reader: readers) {
+        reader.join();
     }
 
-    auto end_time = std::chrono::system_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-    ASSERT_TRUE(elapsed.count() < 10000);
+    for (const auto &reader_got: got) {
+        ASSERT_EQ(reader_got, want);
+    }
 }
+
+TEST_P(GraphStoreTestWithDifferentStrategies, SnapshotIsolation) {
+    std::string label = "testLabel";
+    graph_store::GraphStore gs(4, {{label, {0, 1, 2}}}, {{0, 1}, {1, 2}}, GetParam());
+    if (GetParam().layout == graph_store::GraphStore::AdjacencyLayout::CONCURRENT) {
+        EXPECT_THROW(gs.Snapshot(), std::logic_error);
+        return;
+    }
+
+    const auto snapshot = gs.Snapshot();
+    const auto empty_snapshot_of_snapshot = snapshot->Snapshot();
+
+    // Modify every part of the graph after the snapshot.
+    const auto vertex = gs.CreateVertex();
+    EXPECT_TRUE(gs.CreateEdge(0, 2));
+    EXPECT_TRUE(gs.CreateEdge(2, vertex));
+    EXPECT_TRUE(gs.AddLabel(vertex, label));
+    EXPECT_TRUE(gs.AddLabel(3, "otherLabel"));
+    EXPECT_TRUE(gs.RemoveLabel(1, label));
+
+    graph_util::Path want_before = {2, {0, 1, 2}};
+    for (const auto &view: {snapshot, empty_snapshot_of_snapshot}) {
+        ASSERT_EQ(view->ShortestPath(0, 2, label), want_before);
+        ASSERT_FALSE(view->ShortestPath(0, vertex, label).has_value());
+        ASSERT_FALSE(view->ShortestPath(3, 3, "otherLabel").has_value());
+    }
+
+    graph_util::Path want_after = {2, {0, 2, vertex}};
+    ASSERT_EQ(gs.ShortestPath(0, vertex, label), want_after);
+    ASSERT_TRUE(gs.ShortestPath(3, 3, "otherLabel").has_value());
+
+    // The next snapshot observes the modifications and outlives the store.
+    auto latest = gs.Snapshot();
+    EXPECT_TRUE(gs.CreateEdge(vertex, 0));
+    ASSERT_EQ(latest->ShortestPath(0, vertex, label), want_after);
+    ASSERT_FALSE(latest->ShortestPath(vertex, 0, label).has_value());
+}
+
+// A file path unique to the running test, so that the tests can run in parallel.
+std::string TemporaryFilePath() {
+    std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::replace(name.begin(), name.end(), '/', '_');
+    return ::testing::TempDir() + "graph_store_test_" + name + ".snapshot";
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, SaveAndOpenSnapshot) {
+    const std::uint64_t vertex_count = 300;
+    const auto edges = GenerateRandomGraph(vertex_count, 3 * vertex_count);
+    std::unordered_map<graph_util::Label, graph_util::VertexSet> label_to_vertices;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        label_to_vertices["all"].insert(v);
+        label_to_vertices[v % 3 == 0 ? "sparse" : "dense"].insert(v);
+    }
+    label_to_vertices["empty"];
+
+    const std::string path = TemporaryFilePath();
+    graph_store::GraphStore gs(vertex_count, label_to_vertices, edges, GetParam());
+    gs.SaveSnapshot(path);
+    const auto opened = graph_store::GraphStore::OpenSnapshot(path, GetParam());
+
+    for (int i = 0; i < 100; ++i) {
+        const std::uint64_t src = std::rand() % vertex_count;
+        const std::uint64_t dst = std::rand() % vertex_count;
+        for (const auto &[label, vertices]: label_to_vertices) {
+            const auto want = gs.ShortestPath(src, dst, label);
+            const auto got = opened->ShortestPath(src, dst, label);
+            ASSERT_EQ(got.has_value(), want.has_value());
+            if (got.has_value()) {
+                ASSERT_EQ(got->length, want->length);
+            }
+        }
+    }
+
+    // The opened store can be modified, the file is not.
+    const auto vertex = opened->CreateVertex();
+    ASSERT_TRUE(opened->CreateEdge(0, vertex));
+    ASSERT_TRUE(opened->AddLabel(vertex, "all"));
+    ASSERT_TRUE(opened->AddLabel(vertex, "new"));
+    ASSERT_EQ(opened->ShortestPath(0, vertex, "all").value().length, 1);
+    ASSERT_FALSE(graph_store::GraphStore::OpenSnapshot(path, GetParam())->ShortestPath(0, vertex, "all").has_value());
+    std::remove(path.c_str());
+}
+
+TEST(GraphStoreSnapshotTest, OpenRejectsInvalidFiles) {
+    const std::string path = TemporaryFilePath();
+    EXPECT_THROW(graph_store::GraphStore::OpenSnapshot(path), std::runtime_error);
+
+    {
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        std::fputs("not a snapshot, but long enough to hold the header of one, so that the magic is checked", file);
+        std::fclose(file);
+    }
+    EXPECT_THROW(graph_store::GraphStore::OpenSnapshot(path), std::runtime_error);
+
+    // A truncated snapshot.
+    graph_store::GraphStore gs(3, {{"label", {0, 1, 2}}}, {{0, 1}, {1, 2}}, graph_store::GraphStore::Options{});
+    gs.SaveSnapshot(path);
+    ASSERT_EQ(graph_store::GraphStore::OpenSnapshot(path)->ShortestPath(0, 2, "label").value().length, 2);
+    {
+        std::FILE *file = std::fopen(path.c_str(), "r+b");
+        ASSERT_NE(file, nullptr);
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::fclose(file);
+        ASSERT_EQ(::truncate(path.c_str(), size - 8), 0);
+    }
+    EXPECT_THROW(graph_store::GraphStore::OpenSnapshot(path), std::runtime_error);
+
+    // A snapshot saved with the other width of the vertex IDs.
+    gs.SaveSnapshot(path);
+    {
+        std::FILE *file = std::fopen(path.c_str(), "r+b");
+        ASSERT_NE(file, nullptr);
+        graph_util::SnapshotHeader header;
+        ASSERT_EQ(std::fread(&header, sizeof(header), 1, file), 1);
+        header.flags ^= graph_util::SnapshotHeader::kVertexIds32;
+        std::fseek(file, 0, SEEK_SET);
+        ASSERT_EQ(std::fwrite(&header, sizeof(header), 1, file), 1);
+        std::fclose(file);
+    }
+    EXPECT_THROW(graph_store::GraphStore::OpenSnapshot(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+// Writes the text to the file at the path.
+void WriteTextFile(const std::string &path, const std::string &text) {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs(text.c_str(), file);
+    std::fclose(file);
+}
+
+TEST_P(GraphStoreTestWithDifferentStrategies, LoadEdgeList) {
+    const std::uint64_t vertex_count = 300;
+    const auto edges = GenerateRandomGraph(vertex_count, 3 * vertex_count);
+    std::unordered_map<graph_util::Label, graph_util::VertexSet> label_to_vertices;
+
+    // Mix in the comments, the blank lines, the tabs and the Windows line endings.
+    std::string edge_list = "# Directed graph\n% src dst\n\n";
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        edge_list += std::to_string(edges[i].source_vertex) + (i % 2 == 0 ? " " : "\t  ") +
+                     std::to_string(edges[i].destination_vertex) + (i % 3 == 0 ? "\r\n" : "\n");
+    }
+    // The largest vertex has only a label, and the last line has no line ending.
+    std::string labels = "sparse " + std::to_string(vertex_count - 1) + "\n";
+    label_to_vertices["sparse"].insert(vertex_count - 1);
+    for (std::uint64_t v = 0; v + 1 < vertex_count; ++v) {
+        labels += "all\t" + std::to_string(v) + "\n";
+        label_to_vertices["all"].insert(v);
+        if (v % 3 == 0) {
+            labels += "sparse " + std::to_string(v) + "\n";
+            label_to_vertices["sparse"].insert(v);
+        }
+    }
+    labels += "all " + std::to_string(vertex_count - 1);
+    label_to_vertices["all"].insert(vertex_count - 1);
+
+    const std::string edge_list_path = TemporaryFilePath() + ".edges";
+    const std::string labels_path = TemporaryFilePath() + ".labels";
+    WriteTextFile(edge_list_path, edge_list);
+    WriteTextFile(labels_path, labels);
+
+    const graph_store::GraphStore gs(vertex_count, label_to_vertices, edges, GetParam());
+    const auto loaded = graph_store::GraphStore::LoadEdgeList(edge_list_path, labels_path, GetParam());
+    // The labels get their IDs in the order of their first line.
+    ASSERT_EQ(loaded->InternLabel("sparse"), 0);
+    ASSERT_EQ(loaded->InternLabel("all"), 1);
+
+    for (int i = 0; i < 100; ++i) {
+        const std::uint64_t src = std::rand() % vertex_count;
+        const std::uint64_t dst = std::rand() % vertex_count;
+        for (const auto &[label, vertices]: label_to_vertices) {
+            const auto want = gs.ShortestPath(src, dst, label);
+            const auto got = loaded->ShortestPath(src, dst, label);
+            ASSERT_EQ(got.has_value(), want.has_value());
+            if (got.has_value()) {
+                ASSERT_EQ(got->length, want->length);
+            }
+        }
+    }
+
+    // The loaded store can be modified.
+    const auto vertex = loaded->CreateVertex();
+    ASSERT_EQ(vertex, vertex_count);
+    ASSERT_TRUE(loaded->CreateEdge(0, vertex));
+    ASSERT_TRUE(loaded->AddLabel(vertex, "all"));
+    ASSERT_EQ(loaded->ShortestPath(0, vertex, "all").value().length, 1);
+    std::remove(edge_list_path.c_str());
+    std::remove(labels_path.c_str());
+}
+
+TEST(GraphStoreLoadEdgeListTest, RejectsMalformedFiles) {
+    const std::string path = TemporaryFilePath();
+    graph_store::GraphStore::Options options;
+    EXPECT_THROW(graph_store::GraphStore::LoadEdgeList(path, "", options), std::runtime_error);
+
+    // An empty file is an empty graph.
+    WriteTextFile(path, "");
+    const auto empty = graph_store::GraphStore::LoadEdgeList(path, "", options);
+    ASSERT_EQ(empty->CreateVertex(), 0);
+
+    for (const std::string text: {"0 1\n1\n", "0 1\n1 2 3\n", "0 -1\n", "0 x\n", "0 18446744073709551616\n",
+                                  "01\n"}) {
+        WriteTextFile(path, text);
+        EXPECT_THROW(graph_store::GraphStore::LoadEdgeList(path, "", options), std::runtime_error) << text;
+    }
+    WriteTextFile(path, "0 1\nlabel\n");
+    EXPECT_THROW(graph_store::GraphStore::LoadEdgeList(path, path, options), std::runtime_error);
+
+    WriteTextFile(path, "0 1\n");
+    options.wal_path = path + ".log";
+    EXPECT_THROW(graph_store::GraphStore::LoadEdgeList(path, "", options), std::invalid_argument);
+    std::remove(path.c_str());
+}
+
+TEST(WriteAheadLogTest, ReplayStopsAtTornRecord) {
+    using RecordType = graph_util::WriteAheadLog::RecordType;
+    const std::string path = TemporaryFilePath();
+    std::remove(path.c_str());
+
+    std::vector<graph_util::WriteAheadLog::Record> records;
+    const auto collect = [&records](const graph_util::WriteAheadLog::Record &record) { records.push_back(record); };
+    {
+        graph_util::WriteAheadLog log(path, {}, 0, std::chrono::milliseconds(1000), false);
+        EXPECT_EQ(log.Append(RecordType::CREATE_VERTEX, 0), 1);
+        EXPECT_EQ(log.Append(RecordType::CREATE_EDGE, 0, 1), 2);
+        EXPECT_EQ(log.Append(RecordType::INTERN_LABEL, 0, 0, "label"), 3);
+        log.Sync();
+    }
+
+    auto recovery = graph_util::WriteAheadLog::Replay(path, collect);
+    ASSERT_EQ(records.size(), 3);
+    EXPECT_EQ(recovery.last_sequence_number, 3);
+    EXPECT_EQ(records[1].type, RecordType::CREATE_EDGE);
+    EXPECT_EQ(records[1].vertex_id, 0);
+    EXPECT_EQ(records[1].argument, 1);
+    EXPECT_EQ(records[2].label, "label");
+
+    // A crash in the middle of the last record.
+    ASSERT_EQ(::truncate(path.c_str(), off_t(recovery.valid_size - 1)), 0);
+    records.clear();
+    recovery = graph_util::WriteAheadLog::Replay(path, collect);
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(recovery.last_sequence_number, 2);
+
+    // The log opened for appending cuts off the torn record, the destructor writes the buffered records.
+    {
+        graph_util::WriteAheadLog log(path, recovery, recovery.last_sequence_number, std::chrono::milliseconds(1000),
+                                      false);
+        EXPECT_EQ(log.Append(RecordType::ADD_LABEL, 1, 0), 3);
+    }
+    records.clear();
+    graph_util::WriteAheadLog::Replay(path, collect);
+    ASSERT_EQ(records.size(), 3);
+    EXPECT_EQ(records[2].type, RecordType::ADD_LABEL);
+
+    // A flipped byte fails the checksum of the first record.
+    {
+        std::FILE *file = std::fopen(path.c_str(), "r+b");
+        ASSERT_NE(file, nullptr);
+        std::fseek(file, 12, SEEK_SET);
+        std::fputc(0x7F, file);
+        std::fclose(file);
+    }
+    records.clear();
+    graph_util::WriteAheadLog::Replay(path, collect);
+    EXPECT_TRUE(records.empty());
+    std::remove(path.c_str());
+}
+
+TEST(GraphStoreWriteAheadLogTest, RecoversModificationsOnTopOfSnapshot) {
+    const std::string snapshot_path = TemporaryFilePath();
+    const std::string log_path = snapshot_path + ".log";
+    std::remove(snapshot_path.c_str());
+    std::remove(log_path.c_str());
+
+    graph_store::GraphStore::Options options;
+    options.wal_path = log_path;
+    options.wal_sync = false;
+    EXPECT_THROW(graph_store::GraphStore(1, {}, {}, options), std::invalid_argument);
+
+    {
+        graph_store::GraphStore gs(options);
+        for (std::uint64_t v = 0; v < 10; ++v) {
+            gs.CreateVertex();
+            ASSERT_TRUE(gs.AddLabel(v, "chain"));
+        }
+        for (std::uint64_t v = 0; v + 1 < 10; ++v) {
+            ASSERT_TRUE(gs.CreateEdge(v, v + 1));
+        }
+        gs.SaveSnapshot(snapshot_path);
+
+        // The modifications after the snapshot are only in the log.
+        const auto vertex = gs.CreateVertex();
+        ASSERT_TRUE(gs.CreateEdge(9, vertex));
+        ASSERT_TRUE(gs.AddLabel(vertex, "chain"));
+        ASSERT_TRUE(gs.RemoveLabel(5, "chain"));
+        ASSERT_TRUE(gs.AddLabel(3, "other"));
+        gs.SyncLog();
+    }
+
+    const auto check = [](const graph_store::GraphStore &gs) {
+        ASSERT_EQ(gs.ShortestPath(0, 4, "chain").value().length, 4);
+        ASSERT_FALSE(gs.ShortestPath(0, 6, "chain").has_value());
+        ASSERT_EQ(gs.ShortestPath(6, 10, "chain").value().length, 4);
+        ASSERT_TRUE(gs.ShortestPath(3, 3, "other").has_value());
+        ASSERT_FALSE(gs.ShortestPath(4, 4, "other").has_value());
+    };
+    check(*graph_store::GraphStore::OpenSnapshot(snapshot_path, options));
+
+    // Without the snapshot the whole log is replayed.
+    {
+        graph_store::GraphStore replayed(options);
+        check(replayed);
+    }
+    std::remove(snapshot_path.c_str());
+    std::remove(log_path.c_str());
+}
+
+TEST(GraphStoreWriteAheadLogTest, ReplaysEdgeLoggedBeforeItsVertex) {
+    using RecordType = graph_util::WriteAheadLog::RecordType;
+    const std::string path = TemporaryFilePath();
+    std::remove(path.c_str());
+
+    // With CONCURRENT layout a vertex is visible before its record is appended, so a concurrent CreateEdge on it
+    // may be logged first.
+    {
+        graph_util::WriteAheadLog log(path, {}, 0, std::chrono::milliseconds(1000), false);
+        log.Append(RecordType::CREATE_VERTEX, 0);
+        log.Append(RecordType::CREATE_EDGE, 0, 1);
+        log.Append(RecordType::CREATE_VERTEX, 1);
+        log.Append(RecordType::INTERN_LABEL, 0, 0, "label");
+        log.Append(RecordType::ADD_LABEL, 0, 0);
+        log.Append(RecordType::ADD_LABEL, 1, 0);
+    }
+
+    for (const auto layout: {graph_store::GraphStore::AdjacencyLayout::CONCURRENT,
+                             graph_store::GraphStore::AdjacencyLayout::ADJACENCY_LIST}) {
+        graph_store::GraphStore::Options options;
+        options.layout = layout;
+        options.wal_path = path;
+        options.wal_sync = false;
+        graph_store::GraphStore gs(options);
+        graph_util::Path want = {1, {0, 1}};
+        ASSERT_EQ(gs.ShortestPath(0, 1, "label"), want);
+        EXPECT_EQ(gs.Metrics().vertex_count, 2);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(GraphStoreSnapshotTest, ReadersDoNotObserveConcurrentWrites) {
+    // More vertices than one chunk of the shared adjacency storage, so that the writes modify different chunks.
+    const std::uint64_t vertex_count = 3000;
+    std::string label = "testLabel";
+    graph_util::VertexSet labelled;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        labelled.insert(v);
+    }
+
+    for (const auto layout: {graph_store::GraphStore::AdjacencyLayout::ADJACENCY_LIST,
+                             graph_store::GraphStore::AdjacencyLayout::CSR,
+                             graph_store::GraphStore::AdjacencyLayout::DELTA_CSR,
+                             graph_store::GraphStore::AdjacencyLayout::COMPRESSED_CSR}) {
+        SCOPED_TRACE(static_cast<int>(layout));
+        graph_store::GraphStore::Options options;
+        options.layout = layout;
+        options.delta_merge_threshold = 64;
+        options.store_in_edges = true;
+        options.search = graph_store::GraphStore::SearchAlgorithm::BIDIRECTIONAL_BFS;
+        graph_store::GraphStore gs(vertex_count, {{label, labelled}}, {}, options);
+
+        // The writer builds the chain 0 -> 1 -> ... and publishes a snapshot after every edge. A snapshot taken after
+        // the edge into the vertex v must see the path of length v from 0, and nothing beyond v.
+        std::mutex published_mutex;
+        std::shared_ptr<const graph_store::GraphStore> published = gs.Snapshot();
+        std::uint64_t published_last_vertex = 0;
+
+        std::thread writer([&]() {
+            for (std::uint64_t v = 1; v < vertex_count; ++v) {
+                gs.CreateEdge(v - 1, v);
+                auto snapshot = gs.Snapshot();
+                std::lock_guard<std::mutex> lock(published_mutex);
+                published = std::move(snapshot);
+                published_last_vertex = v;
+            }
+        });
+
+        std::vector<std::thread> readers;
+        std::atomic<int> failures{0};
+        for (int i = 0; i < 3; ++i) {
+            readers.emplace_back([&]() {
+                for (int query = 0; query < 300; ++query) {
+                    std::shared_ptr<const graph_store::GraphStore> snapshot;
+                    std::uint64_t last_vertex;
+                    {
+                        std::lock_guard<std::mutex> lock(published_mutex);
+                        snapshot = published;
+                        last_vertex = published_last_vertex;
+                    }
+                    const auto path = snapshot->ShortestPath(0, last_vertex, label);
+                    if (!path.has_value() || path->length != last_vertex ||
+                        snapshot->ShortestPath(0, std::min(last_vertex + 1, vertex_count - 1), label).has_value() !=
+                        (last_vertex + 1 >= vertex_count)) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+
+        writer.join();
+        for (auto &reader: readers) {
+            reader.join();
+        }
+        EXPECT_EQ(failures.load(), 0);
+    }
+}
+
+TEST(SharedChunkVectorTest, CopiesShareUnmodifiedChunks) {
+    const std::uint64_t chunk_size = graph_util::SharedChunkVector<int>::kChunkSize;
+    const std::uint64_t size = 2 * chunk_size + 10;
+    graph_util::SharedChunkVector<int> original;
+    for (std::uint64_t i = 0; i < size; ++i) {
+        original.PushBack(int(i));
+    }
+
+    // Only the modified chunk and the last chunk receiving the appended element are copied.
+    auto copy = original;
+    copy.Mutable(chunk_size) = -1;
+    copy.PushBack(-2);
+    EXPECT_EQ(&copy[0], &original[0]);
+    EXPECT_NE(&copy[chunk_size], &original[chunk_size]);
+    EXPECT_NE(&copy[2 * chunk_size], &original[2 * chunk_size]);
+    EXPECT_EQ(original[chunk_size], int(chunk_size));
+    EXPECT_EQ(copy[chunk_size], -1);
+    EXPECT_EQ(original.Size(), size);
+    ASSERT_EQ(copy.Size(), size + 1);
+    EXPECT_EQ(copy[size], -2);
+
+    // The chunk held by one vector only is modified in place.
+    const int *owned = &copy[chunk_size];
+    copy.Mutable(chunk_size) = -3;
+    EXPECT_EQ(&copy[chunk_size], owned);
+}
+
+TEST(GraphStoreParallelSearchTest, WideLevelsMatchSerialSearch) {
+    // Dense enough for the levels to outgrow the threshold of the parallel expansion.
+    const std::uint64_t vertex_count = 20000;
+    const auto edges = GenerateRandomGraph(vertex_count, 8 * vertex_count);
+
+    std::string label = "testLabel";
+    graph_util::VertexSet labelled;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        if (v % 4 != 0) {
+            labelled.insert(v);
+        }
+    }
+
+    graph_store::GraphStore::Options options;
+    graph_store::GraphStore serial(vertex_count, {{label, labelled}}, edges, options);
+    options.search = graph_store::GraphStore::SearchAlgorithm::PARALLEL_BFS;
+    options.thread_count = 4;
+    graph_store::GraphStore parallel(vertex_count, {{label, labelled}}, edges, options);
+
+    for (int i = 0; i < 20; ++i) {
+        const std::uint64_t src = std::rand() % vertex_count;
+        const std::uint64_t dst = std::rand() % vertex_count;
+        const auto want = serial.ShortestPath(src, dst, label);
+        const auto got = parallel.ShortestPath(src, dst, label);
+        ASSERT_EQ(got.has_value(), want.has_value());
+        if (!got.has_value()) {
+            continue;
+        }
+
+        // The threads may discover a different shortest path, check that it is a valid one of the same length.
+        ASSERT_EQ(got->length, want->length);
+        ASSERT_EQ(got->vertices.front(), src);
+        ASSERT_EQ(got->vertices.back(), dst);
+        for (std::uint64_t j = 0; j < got->length; ++j) {
+            const graph_util::Edge edge{got->vertices[j], got->vertices[j + 1]};
+            ASSERT_TRUE(labelled.count(edge.destination_vertex) != 0);
+            ASSERT_TRUE(std::any_of(edges.begin(), edges.end(), [&edge](const graph_util::Edge &e) {
+                return e.source_vertex == edge.source_vertex && e.destination_vertex == edge.destination_vertex;
+            }));
+        }
+    }
+
+    // The pooled parents grow with the graph, a vertex created after the queries is reachable.
+    const auto vertex = parallel.CreateVertex();
+    ASSERT_TRUE(parallel.CreateEdge(1, vertex));
+    ASSERT_TRUE(parallel.AddLabel(vertex, label));
+    const auto path = parallel.ShortestPath(1, vertex, label);
+    ASSERT_TRUE(path.has_value());
+    EXPECT_EQ(path->length, 1);
+}
+
+TEST(GraphStoreOptionsTest, SearchRequiresInEdges) {
+    for (const auto search: {graph_store::GraphStore::SearchAlgorithm::BIDIRECTIONAL_BFS,
+                             graph_store::GraphStore::SearchAlgorithm::DIRECTION_OPTIMIZING_BFS}) {
+        graph_store::GraphStore::Options options;
+        options.search = search;
+        EXPECT_THROW(graph_store::GraphStore gs(options), std::invalid_argument);
+
+        options.store_in_edges = true;
+        EXPECT_NO_THROW(graph_store::GraphStore gs(options));
+    }
+}
+
+TEST(GraphStoreOptionsTest, ConcurrentLayoutRejectsLabelMasks) {
+    graph_store::GraphStore::Options options;
+    options.layout = graph_store::GraphStore::AdjacencyLayout::CONCURRENT;
+    options.label_masks = true;
+    EXPECT_THROW(graph_store::GraphStore gs(options), std::invalid_argument);
+}
+
+TEST(ConcurrentAdjacencyTest, ConcurrentAppendsKeepEveryEdge) {
+    // Vertex 0 is shared by all threads so that they race for its blocks, the other vertices span several segments.
+    const int thread_count = 4;
+    const std::uint64_t edges_per_thread = 5000;
+    const std::uint64_t vertex_count = 10000;
+    graph_util::ConcurrentAdjacency adjacency;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (std::uint64_t i = 0; i < vertex_count / thread_count; ++i) {
+                adjacency.AddVertex();
+            }
+            for (std::uint64_t i = 0; i < edges_per_thread; ++i) {
+                adjacency.AddEdge(0, t * edges_per_thread + i);
+                adjacency.AddEdge(1 + (t * edges_per_thread + i) % (vertex_count - 1), t);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(adjacency.VertexCount(), vertex_count);
+    ASSERT_EQ(adjacency.EdgeCount(), 2 * thread_count * edges_per_thread);
+    ASSERT_EQ(adjacency.Degree(0), thread_count * edges_per_thread);
+
+    // Every edge is stored once, and the edges of one thread keep their order.
+    std::vector<std::uint64_t> next_edge(thread_count, 0);
+    adjacency.ForEachNeighbour(0, [&](const std::uint64_t neighbour) {
+        const std::uint64_t t = neighbour / edges_per_thread;
+        EXPECT_EQ(neighbour, t * edges_per_thread + next_edge[t]);
+        ++next_edge[t];
+        return true;
+    });
+    for (int t = 0; t < thread_count; ++t) {
+        EXPECT_EQ(next_edge[t], edges_per_thread);
+    }
+
+    std::uint64_t edge_count = 0;
+    for (std::uint64_t v = 1; v < vertex_count; ++v) {
+        edge_count += adjacency.Degree(v);
+    }
+    EXPECT_EQ(edge_count, thread_count * edges_per_thread);
+
+    // The copy holds the same edges.
+    const graph_util::ConcurrentAdjacency copy(adjacency);
+    ASSERT_EQ(copy.VertexCount(), vertex_count);
+    ASSERT_EQ(copy.EdgeCount(), adjacency.EdgeCount());
+    for (std::uint64_t v = 0; v < vertex_count; v += 97) {
+        graph_util::VertexVector original;
+        graph_util::VertexVector copied;
+        adjacency.ForEachNeighbour(v, [&original](const std::uint64_t neighbour) {
+            original.push_back(neighbour);
+            return true;
+        });
+        copy.ForEachNeighbour(v, [&copied](const std::uint64_t neighbour) {
+            copied.push_back(neighbour);
+            return true;
+        });
+        ASSERT_EQ(copied, original);
+    }
+}
+
+TEST(CsrAdjacencyTest, ParallelBuildMatchesSerialBuild) {
+    // Few vertices with many edges each, and many vertices with few edges each.
+    graph_util::ThreadPool thread_pool(4);
+    for (const std::uint64_t vertex_count: {std::uint64_t(7), std::uint64_t(30000)}) {
+        const auto edges = GenerateRandomGraph(vertex_count, 2 * graph_util::CsrAdjacency::kParallelBuildThreshold);
+        for (const bool transpose: {false, true}) {
+            const auto serial = graph_util::CsrAdjacency::FromEdges(vertex_count, edges, transpose);
+            const auto parallel = graph_util::CsrAdjacency::FromEdges(vertex_count, edges, transpose, &thread_pool);
+            ASSERT_EQ(parallel.VertexCount(), serial.VertexCount());
+            ASSERT_EQ(parallel.EdgeCount(), serial.EdgeCount());
+            for (std::uint64_t v = 0; v < vertex_count; ++v) {
+                graph_util::VertexVector want;
+                graph_util::VertexVector got;
+                serial.ForEachNeighbour(v, [&want](const std::uint64_t neighbour) {
+                    want.push_back(neighbour);
+                    return true;
+                });
+                parallel.ForEachNeighbour(v, [&got](const std::uint64_t neighbour) {
+                    got.push_back(neighbour);
+                    return true;
+                });
+                ASSERT_EQ(got, want);
+            }
+        }
+    }
+}
+
+TEST(GraphGeneratorTest, SameSeedGeneratesSameGraph) {
+    const auto same_edges = [](const std::vector<graph_util::Edge> &a, const std::vector<graph_util::Edge> &b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto &x, const auto &y) {
+            return x.source_vertex == y.source_vertex && x.destination_vertex == y.destination_vertex;
+        });
+    };
+    EXPECT_TRUE(same_edges(graph_util::GenerateRmatGraph(10, 5000, {}, 1),
+                           graph_util::GenerateRmatGraph(10, 5000, {}, 1)));
+    EXPECT_FALSE(same_edges(graph_util::GenerateRmatGraph(10, 5000, {}, 1),
+                            graph_util::GenerateRmatGraph(10, 5000, {}, 2)));
+    EXPECT_TRUE(same_edges(graph_util::GenerateErdosRenyiGraph(1000, 5000, 1),
+                           graph_util::GenerateErdosRenyiGraph(1000, 5000, 1)));
+    EXPECT_FALSE(same_edges(graph_util::GenerateErdosRenyiGraph(1000, 5000, 1),
+                            graph_util::GenerateErdosRenyiGraph(1000, 5000, 2)));
+
+    const auto edges = graph_util::GenerateGridGraph(20, 30);
+    EXPECT_EQ(graph_util::GenerateZipfianLabels(600, 10, 3, 1, 1), graph_util::GenerateZipfianLabels(600, 10, 3, 1, 1));
+    EXPECT_NE(graph_util::GenerateZipfianLabels(600, 10, 3, 1, 1), graph_util::GenerateZipfianLabels(600, 10, 3, 1, 2));
+    EXPECT_EQ(graph_util::GenerateCommunityLabels(600, edges, 10, 0.1, 1),
+              graph_util::GenerateCommunityLabels(600, edges, 10, 0.1, 1));
+    EXPECT_NE(graph_util::GenerateCommunityLabels(600, edges, 10, 0.1, 1),
+              graph_util::GenerateCommunityLabels(600, edges, 10, 0.1, 2));
+}
+
+TEST(GraphGeneratorTest, GraphShapes) {
+    EXPECT_EQ(graph_util::GenerateGridGraph(4, 5).size(), 2 * (4 * 4 + 5 * 3));
+    EXPECT_EQ(graph_util::GenerateChainGraph(10, false).size(), 9);
+    EXPECT_EQ(graph_util::GenerateChainGraph(10, true).size(), 18);
+    EXPECT_EQ(graph_util::GenerateStarGraph(10).size(), 18);
+    EXPECT_TRUE(graph_util::GenerateChainGraph(0, true).empty());
+    EXPECT_THROW(graph_util::GenerateErdosRenyiGraph(0, 1, 1), std::invalid_argument);
+    EXPECT_THROW(graph_util::GenerateKroneckerGraph({{1, 1}}, 3, 10, 1), std::invalid_argument);
+    EXPECT_THROW(graph_util::GenerateKroneckerGraph({{1, -1}, {1, 1}}, 3, 10, 1), std::invalid_argument);
+    EXPECT_THROW(graph_util::GenerateRmatGraph(64, 10, {}, 1), std::invalid_argument);
+
+    // The power law degrees of R-MAT are far more skewed than the uniform ones with the same average.
+    const std::uint64_t vertex_count = 1 << 14;
+    const auto max_degree = [vertex_count](const std::vector<graph_util::Edge> &edges) {
+        std::vector<std::uint64_t> degrees(vertex_count, 0);
+        for (const auto &edge: edges) {
+            EXPECT_LT(edge.source_vertex, vertex_count);
+            EXPECT_LT(edge.destination_vertex, vertex_count);
+            ++degrees[edge.source_vertex];
+        }
+        return *std::max_element(degrees.begin(), degrees.end());
+    };
+    EXPECT_GT(max_degree(graph_util::GenerateRmatGraph(14, 16 * vertex_count, {}, 1)),
+              10 * max_degree(graph_util::GenerateErdosRenyiGraph(vertex_count, 16 * vertex_count, 1)));
+}
+
+TEST(GraphGeneratorTest, LabelDistributions) {
+    const std::uint64_t vertex_count = 10000;
+    const auto uniform = graph_util::GenerateUniformLabels(vertex_count, 10, 1, 1);
+    ASSERT_EQ(uniform.size(), 10);
+    for (const auto &[label, vertices]: uniform) {
+        EXPECT_GT(vertices.size(), vertex_count / 20);
+        EXPECT_LT(vertices.size(), vertex_count / 5);
+    }
+
+    const auto zipfian = graph_util::GenerateZipfianLabels(vertex_count, 100, 1, 1.5, 1);
+    EXPECT_GT(zipfian.at(graph_util::GeneratedLabel(0)).size(), vertex_count / 3);
+    EXPECT_GT(zipfian.at(graph_util::GeneratedLabel(0)).size(),
+              10 * zipfian.at(graph_util::GeneratedLabel(9)).size());
+
+    // Without the noise the communities are connected, so most of the edges stay within one label.
+    const auto edges = graph_util::GenerateGridGraph(100, 100);
+    const auto communities = graph_util::GenerateCommunityLabels(vertex_count, edges, 10, 0, 1);
+    std::vector<std::uint64_t> vertex_label(vertex_count, inf);
+    for (std::uint64_t label = 0; label < 10; ++label) {
+        for (const auto v: communities.at(graph_util::GeneratedLabel(label))) {
+            EXPECT_EQ(vertex_label[v], inf);
+            vertex_label[v] = label;
+        }
+    }
+    std::uint64_t internal_edges = 0;
+    for (const auto &edge: edges) {
+        internal_edges += vertex_label[edge.source_vertex] == vertex_label[edge.destination_vertex];
+    }
+    EXPECT_GT(internal_edges, edges.size() * 9 / 10);
+}
+
+TEST(CompressedCsrAdjacencyTest, DecodesSortedNeighbours) {
+    graph_util::ThreadPool thread_pool(4);
+    const std::uint64_t vertex_count = 30000;
+    auto edges = GenerateRandomGraph(vertex_count, 2 * graph_util::CsrAdjacency::kParallelBuildThreshold);
+    // Duplicate edges, self loops and the gaps that need every length of the encoding.
+    edges.push_back({5, 5});
+    edges.push_back({5, 5});
+    edges.push_back({vertex_count - 1, 0});
+    edges.push_back({0, vertex_count - 1});
+    const auto csr = graph_util::CsrAdjacency::FromEdges(vertex_count, edges);
+    const auto serial = graph_util::CompressedCsrAdjacency::FromCsr(csr);
+    auto compressed = graph_util::CompressedCsrAdjacency::FromCsr(csr, &thread_pool);
+    ASSERT_EQ(compressed.VertexCount(), vertex_count);
+    ASSERT_EQ(compressed.EdgeCount(), csr.EdgeCount());
+    ASSERT_EQ(compressed.EncodedBytes(), serial.EncodedBytes());
+
+    const auto neighbours = [](const auto &adjacency, const std::uint64_t v) {
+        graph_util::VertexVector result;
+        adjacency.ForEachNeighbour(v, [&result](const std::uint64_t neighbour) {
+            result.push_back(neighbour);
+            return true;
+        });
+        return result;
+    };
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        auto want = neighbours(csr, v);
+        std::sort(want.begin(), want.end());
+        ASSERT_EQ(compressed.Degree(v), want.size());
+        ASSERT_EQ(neighbours(compressed, v), want);
+        ASSERT_EQ(neighbours(serial, v), want);
+    }
+
+    // Insertions keep the neighbours sorted and the streams of the other vertices intact.
+    const auto v = compressed.AddVertex();
+    compressed.AddEdge(v, 3);
+    compressed.AddEdge(v, 1);
+    compressed.AddEdge(v, v);
+    compressed.AddEdge(7, 0);
+    EXPECT_EQ(neighbours(compressed, v), graph_util::VertexVector({1, 3, v}));
+    auto want = neighbours(csr, 7);
+    want.push_back(0);
+    std::sort(want.begin(), want.end());
+    EXPECT_EQ(neighbours(compressed, 7), want);
+    EXPECT_EQ(neighbours(compressed, 8), neighbours(serial, 8));
+    EXPECT_EQ(compressed.EdgeCount(), csr.EdgeCount() + 4);
+}
+
+// The compressed layout is smaller than the plain CSR on a graph with locality, where most of the neighbours are close
+// to the vertex, and finds the paths of the same lengths. The search times are compared by BM_ShortestPath.
+TEST(CompressedCsrAdjacencyTest, SmallerThanCsrWithSamePathLengths) {
+    const std::uint64_t vertex_count = 200000;
+    const std::uint64_t queries = 20;
+    std::vector<graph_util::Edge> edges;
+    std::mt19937_64 random(42);
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        for (int i = 0; i < 8; ++i) {
+            edges.push_back({v, (v + random() % 64) % vertex_count});
+        }
+        edges.push_back({v, random() % vertex_count});
+    }
+    std::string label = "testLabel";
+    graph_util::VertexSet labelled;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        labelled.insert(v);
+    }
+
+    const auto csr = graph_util::CsrAdjacency::FromEdges(vertex_count, edges);
+    const auto compressed = graph_util::CompressedCsrAdjacency::FromCsr(csr);
+    const std::uint64_t csr_bytes =
+            (vertex_count + 1) * sizeof(std::uint64_t) + edges.size() * sizeof(graph_util::VertexId);
+    EXPECT_LT(compressed.EncodedBytes(), csr_bytes);
+
+    std::vector<std::optional<graph_util::Path>> paths[2];
+    for (const int i: {0, 1}) {
+        graph_store::GraphStore::Options options;
+        options.layout = i == 0 ? graph_store::GraphStore::AdjacencyLayout::CSR
+                                : graph_store::GraphStore::AdjacencyLayout::COMPRESSED_CSR;
+        graph_store::GraphStore gs(vertex_count, {{label, labelled}}, edges, options);
+        std::mt19937_64 query_random(7);
+        for (std::uint64_t q = 0; q < queries; ++q) {
+            paths[i].push_back(gs.ShortestPath(query_random() % vertex_count, query_random() % vertex_count, label));
+        }
+    }
+    for (std::uint64_t q = 0; q < queries; ++q) {
+        ASSERT_EQ(paths[0][q].has_value(), paths[1][q].has_value());
+        if (paths[0][q].has_value()) {
+            EXPECT_EQ(paths[0][q]->length, paths[1][q]->length);
+        }
+    }
+}
+
+TEST(GraphStoreConcurrentInsertionTest, ParallelIngestMatchesSerialLoad) {
+    const std::uint64_t vertex_count = 5000;
+    const int thread_count = 4;
+    const auto edges = GenerateRandomGraph(vertex_count, 4 * vertex_count);
+
+    std::string label = "testLabel";
+    graph_util::VertexSet labelled;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        labelled.insert(v);
+    }
+    graph_store::GraphStore serial(vertex_count, {{label, labelled}}, edges, graph_store::GraphStore::Options{});
+
+    graph_store::GraphStore::Options options;
+    options.layout = graph_store::GraphStore::AdjacencyLayout::CONCURRENT;
+    options.store_in_edges = true;
+    options.search = graph_store::GraphStore::SearchAlgorithm::DIRECTION_OPTIMIZING_BFS;
+    graph_store::GraphStore gs(options);
+
+    // Every thread creates its share of the vertices and labels them, the IDs must not collide.
+    std::vector<std::vector<std::uint64_t>> created(thread_count);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (std::uint64_t i = t; i < vertex_count; i += thread_count) {
+                const std::uint64_t vertex = gs.CreateVertex();
+                created[t].push_back(vertex);
+                gs.AddLabel(vertex, label);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    threads.clear();
+
+    std::vector<bool> seen(vertex_count, false);
+    for (const auto &vertices: created) {
+        for (const auto vertex: vertices) {
+            ASSERT_LT(vertex, vertex_count);
+            ASSERT_FALSE(seen[vertex]);
+            seen[vertex] = true;
+        }
+    }
+
+    // Load the edges from all threads, while a snapshot file is saved in the middle of the load. Snapshot is not
+    // supported with the concurrent layout.
+    EXPECT_THROW(gs.Snapshot(), std::logic_error);
+    const std::string path = TemporaryFilePath();
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (std::size_t i = t; i < edges.size(); i += thread_count) {
+                if (t == 0 && i == edges.size() / 2) {
+                    gs.SaveSnapshot(path);
+                }
+                EXPECT_TRUE(gs.CreateEdge(edges[i].source_vertex, edges[i].destination_vertex));
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    const auto snapshot = graph_store::GraphStore::OpenSnapshot(path);
+    std::remove(path.c_str());
+    EXPECT_FALSE(gs.CreateEdge(0, vertex_count));
+
+    for (int i = 0; i < 50; ++i) {
+        const std::uint64_t src = std::rand() % vertex_count;
+        const std::uint64_t dst = std::rand() % vertex_count;
+        const auto want = serial.ShortestPath(src, dst, label);
+        const auto got = gs.ShortestPath(src, dst, label);
+        ASSERT_EQ(got.has_value(), want.has_value());
+        if (got.has_value()) {
+            ASSERT_EQ(got->length, want->length);
+        }
+
+        // The snapshot holds a part of the edges, so its paths are never shorter.
+        const auto partial = snapshot->ShortestPath(src, dst, label);
+        if (partial.has_value()) {
+            ASSERT_TRUE(want.has_value());
+            ASSERT_GE(partial->length, want->length);
+        }
+    }
+}
+
+TEST(VertexStateTest, EpochVertexStateSurvivesWraparound) {
+    // Start two epochs before the wraparound.
+    graph_util::EpochVertexState state(std::numeric_limits<std::uint32_t>::max() - 1);
+    for (int i = 0; i < 3; ++i) {
+        state.ProcessVertexAddition();
+    }
+
+    for (int query = 0; query < 5; ++query) {
+        for (std::uint64_t v = 0; v < 3; ++v) {
+            ASSERT_EQ(state.GetDistance(v), std::numeric_limits<std::uint64_t>::max());
+        }
+
+        state.SetDistance(query % 3, query);
+        state.SetParent(query % 3, 2);
+        ASSERT_EQ(state.GetDistance(query % 3), query);
+        ASSERT_EQ(state.GetParent(query % 3), 2);
+        state.Reset();
+    }
+}
+
+TEST(ThreadPoolTest, RunsTaskOnEveryThread) {
+    graph_util::ThreadPool pool(4);
+    ASSERT_EQ(pool.ThreadCount(), 4);
+
+    std::vector<int> runs(pool.ThreadCount(), 0);
+    for (int i = 0; i < 100; ++i) {
+        pool.Run([&runs](const std::size_t thread_index) { ++runs[thread_index]; });
+    }
+    EXPECT_EQ(runs, std::vector<int>(4, 100));
+}
+
+TEST(MetricsTest, HistogramBucketsCoverLatencies) {
+    std::vector<std::uint64_t> latencies;
+    for (std::uint64_t v = 0; v < 5000; ++v) {
+        latencies.push_back(v);
+    }
+    for (unsigned power = 13; power < 40; ++power) {
+        for (const std::int64_t delta: {-1, 0, 1, 12345}) {
+            latencies.push_back((std::uint64_t(1) << power) + std::uint64_t(delta));
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::size_t previous_bucket = 0;
+    for (const auto latency: latencies) {
+        const auto bucket = graph_util::LatencyHistogram::BucketIndex(latency);
+        ASSERT_LT(bucket, graph_util::LatencyHistogram::kBucketCount);
+        const auto lower = graph_util::LatencyHistogram::BucketLowerBound(bucket);
+        const auto upper = graph_util::LatencyHistogram::BucketUpperBound(bucket);
+        ASSERT_LE(lower, latency);
+        ASSERT_LT(latency, upper);
+        // At most 12.5% wide relative to the values in the bucket.
+        ASSERT_LE((upper - lower) * 8, std::max<std::uint64_t>(lower, 8));
+        ASSERT_GE(bucket, previous_bucket);
+        previous_bucket = bucket;
+    }
+
+    // The buckets are adjacent, and the longest latencies fall into the last one.
+    for (std::size_t bucket = 1; bucket < graph_util::LatencyHistogram::kBucketCount; ++bucket) {
+        ASSERT_EQ(graph_util::LatencyHistogram::BucketLowerBound(bucket),
+                  graph_util::LatencyHistogram::BucketUpperBound(bucket - 1));
+    }
+    EXPECT_EQ(graph_util::LatencyHistogram::BucketIndex(std::numeric_limits<std::uint64_t>::max()),
+              graph_util::LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(MetricsTest, ConcurrentRecordingKeepsEveryCall) {
+    graph_util::MetricsRegistry registry;
+    const std::size_t thread_count = 8;
+    const std::uint64_t calls_per_thread = 10000;
+
+    // Every thread records the latencies 1 to 10000 ns, 100 calls each of the lengths 100, 200, ..., 10000 ns.
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&registry, t] {
+            for (std::uint64_t i = 0; i < calls_per_thread; ++i) {
+                const auto operation = t % 2 == 0 ? graph_util::Operation::SHORTEST_PATH
+                                                  : graph_util::Operation::CREATE_EDGE;
+                registry.Record(operation, std::chrono::nanoseconds((i % 100 + 1) * 100));
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    const auto operations = registry.Collect();
+    const std::uint64_t calls_per_operation = calls_per_thread * thread_count / 2;
+    for (const auto operation: {graph_util::Operation::SHORTEST_PATH, graph_util::Operation::CREATE_EDGE}) {
+        const auto &metrics = operations[std::size_t(operation)];
+        EXPECT_EQ(metrics.count, calls_per_operation);
+        EXPECT_EQ(metrics.total_time.count(), calls_per_operation * 5050);
+        // The exact percentiles are 5000 and 9900 ns, the buckets round them up by at most 12.5%.
+        EXPECT_GE(metrics.Percentile(0.5).count(), 5000);
+        EXPECT_LE(metrics.Percentile(0.5).count(), 5625);
+        EXPECT_GE(metrics.Percentile(0.99).count(), 9900);
+        EXPECT_LE(metrics.Percentile(0.99).count(), 11138);
+        EXPECT_GE(metrics.Percentile(1).count(), 10000);
+    }
+    EXPECT_EQ(operations[std::size_t(graph_util::Operation::CREATE_VERTEX)].count, 0);
+    EXPECT_EQ(operations[std::size_t(graph_util::Operation::CREATE_VERTEX)].Percentile(0.5).count(), 0);
+}
+
+TEST(MetricsTest, PrometheusHistogramIsCumulative) {
+    graph_util::MetricsRegistry registry;
+    registry.Record(graph_util::Operation::ADD_LABEL, std::chrono::nanoseconds(100));
+    registry.Record(graph_util::Operation::ADD_LABEL, std::chrono::nanoseconds(300));
+    registry.Record(graph_util::Operation::ADD_LABEL, std::chrono::seconds(100));
+
+    graph_util::StoreMetrics metrics;
+    metrics.operations = registry.Collect();
+    metrics.memory_bytes.emplace_back("adjacency", 42);
+    const std::string text = graph_util::ToPrometheusText(metrics);
+
+    const auto contains = [&text](const std::string &line) { return text.find(line + "\n") != std::string::npos; };
+    EXPECT_TRUE(contains("# TYPE graph_store_operation_duration_seconds histogram"));
+    EXPECT_TRUE(contains("graph_store_operation_duration_seconds_bucket{operation=\"add_label\",le=\"0.000000256\"} 1"));
+    EXPECT_TRUE(contains("graph_store_operation_duration_seconds_bucket{operation=\"add_label\",le=\"0.000000512\"} 2"));
+    EXPECT_TRUE(contains("graph_store_operation_duration_seconds_bucket{operation=\"add_label\",le=\"68.719476736\"} 2"));
+    EXPECT_TRUE(contains("graph_store_operation_duration_seconds_bucket{operation=\"add_label\",le=\"+Inf\"} 3"));
+    EXPECT_TRUE(contains("graph_store_operation_duration_seconds_sum{operation=\"add_label\"} 100.000000400"));
+    EXPECT_TRUE(contains("graph_store_operations_total{operation=\"add_label\"} 3"));
+    EXPECT_TRUE(contains("graph_store_operations_total{operation=\"remove_label\"} 0"));
+    EXPECT_TRUE(contains("graph_store_memory_bytes{structure=\"adjacency\"} 42"));
+}
+
+TEST(GraphStoreOptionsTest, MetricsCanBeDisabled) {
+    graph_store::GraphStore::Options options;
+    options.metrics = false;
+    graph_store::GraphStore gs(options);
+    gs.CreateVertex();
+    const auto metrics = gs.Metrics();
+    EXPECT_EQ(metrics[graph_util::Operation::CREATE_VERTEX].count, 0);
+    EXPECT_EQ(metrics.vertex_count, 1);
+}
+
+TEST(MemoryUsageTest, CountingAllocatorTracksHashMap) {
+    graph_util::CountingAllocator<int> allocator;
+    {
+        graph_util::CountedHashMap<std::uint64_t, std::uint64_t> map;
+        allocator = map.get_allocator();
+        EXPECT_EQ(allocator.AllocatedBytes(), 0);
+        for (std::uint64_t i = 0; i < 1000; ++i) {
+            map[i] = i;
+        }
+        const auto footprint = graph_util::HashMapFootprint(map);
+        EXPECT_EQ(footprint.allocated, allocator.AllocatedBytes());
+        EXPECT_GE(footprint.allocated, 1000 * 2 * sizeof(std::uint64_t) + map.bucket_count() * sizeof(void *));
+
+        // The copy counts its own allocations.
+        auto copy = map;
+        EXPECT_NE(copy.get_allocator(), map.get_allocator());
+        EXPECT_GE(copy.get_allocator().AllocatedBytes(), 1000 * 2 * sizeof(std::uint64_t));
+        EXPECT_EQ(allocator.AllocatedBytes(), footprint.allocated);
+
+        // The cleared map keeps its buckets, which are slack.
+        map.clear();
+        EXPECT_EQ(allocator.AllocatedBytes(), map.bucket_count() * sizeof(void *));
+        EXPECT_EQ(graph_util::HashMapFootprint(map).slack, allocator.AllocatedBytes());
+    }
+    EXPECT_EQ(allocator.AllocatedBytes(), 0);
+}
+
+TEST(MemoryUsageTest, StrategiesTradeStateMemory) {
+    // The vector-based states hold O(V) memory between the queries, the hash map state holds only its buckets.
+    const std::uint64_t vertex_count = 1 << 16;
+    graph_util::VertexSet labelled;
+    for (std::uint64_t v = 0; v < vertex_count; ++v) {
+        labelled.insert(v);
+    }
+    const auto edges = graph_util::GenerateChainGraph(vertex_count, false);
+
+    std::unordered_map<int, graph_util::MemoryUsage> usages;
+    for (const auto strategy: {graph_store::GraphStore::Strategy::OPTIMIZED_PERFORMANCE,
+                               graph_store::GraphStore::Strategy::OPTIMIZED_MEMORY,
+                               graph_store::GraphStore::Strategy::OPTIMIZED_RESET}) {
+        graph_store::GraphStore gs(vertex_count, {{"label", labelled}}, edges, strategy);
+        ASSERT_TRUE(gs.ShortestPath(0, 100, "label").has_value());
+        usages[int(strategy)] = gs.MemoryUsage();
+    }
+
+    const auto &performance = usages[int(graph_store::GraphStore::Strategy::OPTIMIZED_PERFORMANCE)];
+    const auto &memory = usages[int(graph_store::GraphStore::Strategy::OPTIMIZED_MEMORY)];
+    const auto &reset = usages[int(graph_store::GraphStore::Strategy::OPTIMIZED_RESET)];
+    EXPECT_GE(performance.vertex_state, 2 * vertex_count * sizeof(graph_util::VertexId));
+    EXPECT_GE(reset.vertex_state, 2 * vertex_count * sizeof(graph_util::VertexId));
+    EXPECT_LT(memory.vertex_state, 1024);
+    EXPECT_EQ(memory.adjacency, performance.adjacency);
+    EXPECT_EQ(memory.label_index, performance.label_index);
+}
+
+TEST(LabelIndexTest, CompressedBitmapMatchesSet) {
+    graph_util::CompressedBitmap bitmap;
+    graph_util::VertexSet want;
+
+    // Dense enough in the first chunk to convert its container to the bitmap and back.
+    for (std::uint64_t round = 0; round < 3; ++round) {
+        for (auto i = 0; i < 20000; ++i) {
+            std::uint64_t vertex = (std::rand() % 8 == 0) ? std::rand() % (1 << 20) : std::rand() % 6000;
+            EXPECT_EQ(bitmap.Insert(vertex), want.insert(vertex).second);
+        }
+        for (auto i = 0; i < 20000; ++i) {
+            std::uint64_t vertex = std::rand() % 6000;
+            EXPECT_EQ(bitmap.Erase(vertex), want.erase(vertex) == 1);
+        }
+        ASSERT_EQ(bitmap.Size(), want.size());
+        for (std::uint64_t vertex = 0; vertex < (1 << 20); ++vertex) {
+            ASSERT_EQ(bitmap.Contains(vertex), want.count(vertex) == 1);
+        }
+
+        std::vector<std::uint64_t> visited;
+        bitmap.ForEach([&visited](const std::uint64_t vertex) { visited.push_back(vertex); });
+        ASSERT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+        ASSERT_EQ(graph_util::VertexSet(visited.begin(), visited.end()), want);
+    }
+}
+
+TEST(LabelIndexTest, LabelMembershipSwitchesRepresentation) {
+    graph_util::LabelMembership membership;
+    const std::uint64_t vertex_count = 1 << 16;
+
+    membership.Insert(vertex_count - 1);
+    EXPECT_FALSE(membership.IsDense());
+
+    for (std::uint64_t vertex = 0; vertex < vertex_count; vertex += 8) {
+        membership.Insert(vertex);
+    }
+    EXPECT_TRUE(membership.IsDense());
+    EXPECT_EQ(membership.Size(), vertex_count / 8 + 1);
+
+    for (std::uint64_t vertex = 0; vertex < vertex_count; vertex += 8) {
+        membership.Erase(vertex);
+    }
+    EXPECT_FALSE(membership.IsDense());
+    EXPECT_EQ(membership.Size(), 1);
+    EXPECT_TRUE(membership.Contains(vertex_count - 1));
+    EXPECT_FALSE(membership.Contains(0));
+}
+